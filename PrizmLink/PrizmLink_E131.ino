@@ -7,6 +7,9 @@
 #include "network_e131.h"
 #include "pixel_output.h"
 #include "dmx_output.h"
+#include "dmx_input.h"
+#include "dmx_patch.h"
+#include "rdm_controller.h"
 #include "failsafe_fx.h"
 #include "pot_control.h"
 #include "buttons.h"
@@ -46,14 +49,25 @@ static void initConfig() {
 }
 
 static void initSubsystems() {
+  DMXPatch::compile(Config::active);
+
   if (Config::active.pixels.enabled) {
-    PixelOutput::begin(Config::active.pixels);
-    FailsafeFX::begin(Config::active.pixels.count);
+    PixelOutput::begin(Config::active.pixels, Config::active.e131);
+    FailsafeFX::begin(totalPixels(Config::active.pixels));
   }
 
   if (Config::active.dmx.enabled) {
     DMXOutput::begin(Config::active.dmx);
   }
+  bool inputUartFree = true;
+  for (uint8_t i = 0; Config::active.dmx.enabled && i < Config::active.dmx.portCount; ++i) {
+    inputUartFree &= Config::active.dmx.ports[i].uart != Config::active.dmxIn.uart;
+  }
+  if (!inputUartFree) {
+    Debug::error("DMXIN", "UART%u is already a DMX output", Config::active.dmxIn.uart);
+  } else {
+    DMXInput::begin(Config::active.dmxIn);
+  }
 
   PotControl::begin(Config::active.pots);
   Buttons::begin(Config::active.buttons);
@@ -61,6 +75,9 @@ static void initSubsystems() {
   OLEDDisplay::begin(Config::active.oled);
 
   NetworkE131::begin(Config::active);
+  if (Config::active.dmx.enabled) {
+    RDMController::begin(Config::active.dmx);
+  }
   WebServer::begin(Config::active);
 }
 
@@ -70,7 +87,62 @@ static void updateStats(bool networkActive) {
   stats.manualOverride = NetworkE131::manualOverride();
   stats.lastPacketMs = NetworkE131::lastPacketMs();
   stats.fps = NetworkE131::fps();
-  stats.packetCounter = NetworkE131::lastPacket().sequence;
+  NetworkE131::PacketStats packets = NetworkE131::packetStats();
+  stats.packetCounter = packets.accepted;
+  stats.packetsStale = packets.stale;
+  stats.packetsDuplicate = packets.duplicate;
+  stats.packetsLost = packets.lost;
+  stats.frameOverruns = packets.overruns;
+  stats.rxQueuePeak = packets.queuePeak;
+  stats.artnetPackets = packets.artnet;
+  stats.ddpPackets = packets.ddp;
+  PixelOutput::OutputStats pixels = PixelOutput::stats();
+  stats.pixelFramesBusy = pixels.busy;
+  stats.pixelFramesDropped = pixels.dropped;
+  stats.pixelMilliamps = pixels.milliamps;
+  stats.pixelPowerLimited = pixels.limited;
+  DMXOutput::OutputStats dmx = DMXOutput::stats();
+  stats.dmxFrames = dmx.frames;
+  stats.dmxMissed = dmx.missed;
+  DMXInput::InputStats dmxIn = DMXInput::stats();
+  stats.dmxInFps = dmxIn.fps;
+  stats.dmxInSlots = dmxIn.slots;
+}
+
+// Each port pulls its patched channels straight from the receive frame.
+static void updateDMXPorts() {
+  for (uint8_t i = 0; i < DMXOutput::portCount(); ++i) {
+    DMXPatch::Route route;
+    if (!DMXPatch::resolve(DMXPatch::dmxPort(i), route)) continue;
+    if (route.index) {
+      DMXOutput::update(i, route.data, route.length, route.index, route.count);
+    } else if (route.length > route.offset) {
+      DMXOutput::update(i, route.data + route.offset, std::min(route.length - route.offset, route.count));
+    }
+  }
+}
+
+// Runtime universe change: the receive task re-slots on its next pass and
+// the pixel offsets follow once a frame in the new layout is taken.
+static void applyUniverseChange() {
+  Prizm::E131Config e131 = Config::active.e131;
+  if (!WebServer::takeUniverseChange(e131)) return;
+  Config::active.e131 = e131;
+  NetworkE131::reconfigure(e131);
+  DMXPatch::compile(Config::active);
+  if (SDLogger::isReady()) Config::save(SD, "/config.json");
+  Debug::info("NET", "Universes %u-%u requested", e131.startUniverse,
+              e131.startUniverse + e131.universeCount - 1);
+}
+
+static void followFrameLayout() {
+  static uint32_t generation = 0;
+  NetworkE131::FrameLayout layout = NetworkE131::frameLayout();
+  if (layout.generation == generation) return;
+  generation = layout.generation;
+  if (Config::active.pixels.enabled) {
+    PixelOutput::setSourceLayout(layout.startUniverse, layout.channelsPerUniverse);
+  }
 }
 
 static void handleButtons() {
@@ -123,28 +195,28 @@ static void handleNetwork() {
     brightnessScalar = std::max(brightnessScalar, Config::active.failsafe.brightnessFloor / 255.0f);
   }
 
-  size_t len = 0;
-  const uint8_t *dmx = NetworkE131::dmxData(len);
   if (Config::active.dmx.enabled && !failsafeActive && active) {
-    DMXOutput::update(dmx, len);
+    updateDMXPorts();
   }
 
   if (Config::active.servos.enabled) {
-    float servoTargets[4];
-    for (size_t i = 0; i < 4; ++i) {
-      uint8_t value = (dmx && i < len) ? dmx[i] : 127;
-      float norm = value / 255.0f;
+    float servoTargets[DMXPatch::kServoCount];
+    DMXPatch::Route route;
+    bool patched = DMXPatch::resolve(DMXPatch::Servos, route);
+    for (size_t i = 0; i < DMXPatch::kServoCount; ++i) {
+      uint16_t value = patched ? DMXPatch::value16(route, i, 127 * 257) : 127 * 257;
+      float norm = value / 65535.0f;
       servoTargets[i] = Config::active.servos.minServoAngle +
                         norm * (Config::active.servos.maxServoAngle - Config::active.servos.minServoAngle);
     }
     if (failsafeActive || !active) {
       for (auto &angle : servoTargets) angle = Config::active.servos.neutralAngle;
     }
-    JoystickServo::setNetworkTargets(servoTargets, 4);
+    JoystickServo::setNetworkTargets(servoTargets, DMXPatch::kServoCount);
   }
 
-  size_t pixLen = 0;
-  const uint8_t *pixels = NetworkE131::pixelData(pixLen);
+  bool newFrame = NetworkE131::takeFrame();
+  if (newFrame) followFrameLayout();
   if (Config::active.pixels.enabled) {
     if (failsafeActive || !active) {
       if (Config::active.failsafe.enableFx) {
@@ -152,7 +224,10 @@ static void handleNetwork() {
       } else {
         PixelOutput::blackout();
       }
-    } else {
+    } else if (newFrame || PixelOutput::needsRender(brightnessScalar)) {
+      // A static source is re-rendered from the held frame when brightness moves.
+      size_t pixLen = 0;
+      const uint8_t *pixels = NetworkE131::pixelData(pixLen);
       PixelOutput::updateFromE131(pixels, pixLen, brightnessScalar);
     }
   }
@@ -179,6 +254,7 @@ void setup() {
 
 void loop() {
   handleButtons();
+  applyUniverseChange();
   handleNetwork();
   handleServos();
 
@@ -0,0 +1,85 @@
+#include <cstring>
+#include <algorithm>
+#include "artnet.h"
+
+namespace ArtNet {
+
+static const char kId[8] = {'A', 'r', 't', '-', 'N', 'e', 't', 0};
+constexpr uint8_t kProtocolVersion = 14;
+constexpr size_t kDmxHeaderLength = 18;
+
+// ArtPollReply field offsets (Art-Net 4)
+constexpr size_t kReplyIp = 10;
+constexpr size_t kReplyPort = 14;
+constexpr size_t kReplyVersion = 16;
+constexpr size_t kReplyNetSwitch = 18;
+constexpr size_t kReplySubSwitch = 19;
+constexpr size_t kReplyStatus1 = 23;
+constexpr size_t kReplyShortName = 26;
+constexpr size_t kReplyLongName = 44;
+constexpr size_t kReplyNodeReport = 108;
+constexpr size_t kReplyNumPorts = 172;
+constexpr size_t kReplyPortTypes = 174;
+constexpr size_t kReplyGoodOutput = 182;
+constexpr size_t kReplySwOut = 190;
+constexpr size_t kReplyStyle = 200;
+constexpr size_t kReplyMac = 201;
+constexpr size_t kReplyBindIp = 207;
+constexpr size_t kReplyBindIndex = 211;
+constexpr size_t kReplyStatus2 = 212;
+
+bool parseHeader(const uint8_t *data, size_t len, OpCode &opcode) {
+  if (!data || len < 10) return false;
+  if (memcmp(data, kId, sizeof(kId)) != 0) return false;
+  opcode = static_cast<OpCode>(data[8] | (data[9] << 8));
+  return true;
+}
+
+bool parseDmx(const uint8_t *data, size_t len, DmxPacket &out) {
+  if (len < kDmxHeaderLength + 2) return false;
+  uint16_t version = (data[10] << 8) | data[11];
+  if (version < kProtocolVersion) return false;
+
+  out.sequence = data[12];
+  out.portAddress = ((data[15] & 0x7F) << 8) | data[14];
+  out.length = (data[16] << 8) | data[17];
+  if (out.length < 2 || out.length > 512) return false;
+  if (len < kDmxHeaderLength + out.length) return false;
+  out.data = &data[kDmxHeaderLength];
+  return true;
+}
+
+size_t buildPollReply(const PollReplyInfo &info, uint8_t *out, size_t cap) {
+  if (!out || cap < kPollReplyLength) return 0;
+  memset(out, 0, kPollReplyLength);
+
+  memcpy(out, kId, sizeof(kId));
+  out[8] = static_cast<uint16_t>(OpCode::PollReply) & 0xFF;
+  out[9] = static_cast<uint16_t>(OpCode::PollReply) >> 8;
+  memcpy(&out[kReplyIp], info.ip, 4);
+  out[kReplyPort] = kPort & 0xFF;
+  out[kReplyPort + 1] = kPort >> 8;
+  out[kReplyVersion + 1] = 1;
+  out[kReplyNetSwitch] = (info.portAddress >> 8) & 0x7F;
+  out[kReplySubSwitch] = (info.portAddress >> 4) & 0x0F;
+  out[kReplyStatus1] = 0xD0; // indicators normal, port-address from local config
+  strncpy(reinterpret_cast<char*>(&out[kReplyShortName]), info.shortName, 17);
+  strncpy(reinterpret_cast<char*>(&out[kReplyLongName]), info.longName, 63);
+  strncpy(reinterpret_cast<char*>(&out[kReplyNodeReport]), "#0001 [0000] Power On Tests successful", 63);
+
+  uint8_t ports = std::min<uint8_t>(info.ports, 4);
+  out[kReplyNumPorts + 1] = ports;
+  for (uint8_t i = 0; i < ports; ++i) {
+    out[kReplyPortTypes + i] = 0x80;  // outputs DMX512 from Art-Net
+    out[kReplyGoodOutput + i] = 0x80; // data is being transmitted
+    out[kReplySwOut + i] = (info.portAddress + i) & 0x0F;
+  }
+  out[kReplyStyle] = 0x00; // StNode
+  memcpy(&out[kReplyMac], info.mac, 6);
+  memcpy(&out[kReplyBindIp], info.ip, 4);
+  out[kReplyBindIndex] = info.bindIndex;
+  out[kReplyStatus2] = 0x0D; // web config, DHCP capable, 15-bit port-address
+  return kPollReplyLength;
+}
+
+} // namespace ArtNet
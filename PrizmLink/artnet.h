@@ -0,0 +1,44 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace ArtNet {
+
+constexpr uint16_t kPort = 6454;
+constexpr size_t kPollReplyLength = 239;
+
+enum class OpCode : uint16_t {
+  Poll = 0x2000,
+  PollReply = 0x2100,
+  Dmx = 0x5000,
+  Sync = 0x5200
+};
+
+struct DmxPacket {
+  uint16_t portAddress {0};  // 15-bit Net:SubNet:Universe
+  uint8_t sequence {0};      // 0 = sequencing disabled by the sender
+  uint16_t length {0};
+  const uint8_t *data {nullptr};
+};
+
+struct PollReplyInfo {
+  uint8_t ip[4] {0};
+  uint8_t mac[6] {0};
+  uint16_t portAddress {0};  // first port; up to four consecutive ports per reply
+  uint8_t ports {0};
+  uint8_t bindIndex {1};
+  const char *shortName {""};
+  const char *longName {""};
+};
+
+// Validates the "Art-Net\0" ID and returns the little-endian opcode.
+bool parseHeader(const uint8_t *data, size_t len, OpCode &opcode);
+
+// Parses an ArtDmx body in place; `out.data` points into `data`.
+bool parseDmx(const uint8_t *data, size_t len, DmxPacket &out);
+
+// Builds one ArtPollReply for up to four output ports sharing Net/SubNet.
+// Returns the number of bytes written (kPollReplyLength) or 0 if `cap` is short.
+size_t buildPollReply(const PollReplyInfo &info, uint8_t *out, size_t cap);
+
+} // namespace ArtNet
@@ -17,6 +17,93 @@ void applyDefaults(PrizmConfig &cfg) {
   cfg = PrizmConfig{}; // value initialize with defaults declared in structs
 }
 
+static ColorOrder parseColorOrder(const String &order) {
+  if (order == "rgb") return ColorOrder::RGB;
+  if (order == "rbg") return ColorOrder::RBG;
+  if (order == "gbr") return ColorOrder::GBR;
+  if (order == "brg") return ColorOrder::BRG;
+  if (order == "bgr") return ColorOrder::BGR;
+  return ColorOrder::GRB;
+}
+
+static const char *colorOrderName(ColorOrder order) {
+  switch (order) {
+    case ColorOrder::RGB: return "rgb";
+    case ColorOrder::RBG: return "rbg";
+    case ColorOrder::GBR: return "gbr";
+    case ColorOrder::BRG: return "brg";
+    case ColorOrder::BGR: return "bgr";
+    default:              return "grb";
+  }
+}
+
+static void loadPixelOutput(JsonObject obj, PixelOutputConfig &out) {
+  if (obj.containsKey("count")) out.count = obj["count"].as<uint16_t>();
+  if (obj.containsKey("pin")) out.dataPin = obj["pin"].as<uint8_t>();
+  if (obj.containsKey("chipset")) {
+    String chipset = obj["chipset"].as<const char*>();
+    out.chipset = chipset == "sk6812" ? PixelChipset::SK6812 : PixelChipset::WS2812B;
+  }
+  if (obj.containsKey("order")) {
+    out.order = parseColorOrder(obj["order"].as<const char*>());
+  } else if (obj.containsKey("grbw")) {
+    // Single-strip configs: the SK6812 wire order was always GRBW, which the
+    // default "grb" order reproduces.
+    out.order = ColorOrder::GRB;
+    Debug::warn("Config", "pixels.grbw is obsolete, using order \"grb\"; set \"order\" instead");
+  }
+  if (obj.containsKey("sk6812") && obj["sk6812"].as<bool>()) out.chipset = PixelChipset::SK6812;
+  if (obj.containsKey("universe")) out.startUniverse = obj["universe"].as<uint16_t>();
+  if (obj.containsKey("channel")) out.startChannel = std::max<uint16_t>(obj["channel"].as<uint16_t>(), 1);
+  if (obj.containsKey("gamma")) out.gamma = obj["gamma"].as<float>();
+  if (obj.containsKey("dither")) out.dither = obj["dither"].as<bool>();
+  if (obj.containsKey("16bit")) out.input16 = obj["16bit"].as<bool>();
+  if (obj.containsKey("reverse")) out.reverse = obj["reverse"].as<bool>();
+  if (obj.containsKey("width")) out.width = obj["width"].as<uint16_t>();
+  if (obj.containsKey("serpentine")) out.serpentine = obj["serpentine"].as<bool>();
+  if (obj.containsKey("group")) out.group = std::max<uint8_t>(obj["group"].as<uint8_t>(), 1);
+  if (obj.containsKey("nulls")) out.nullPixels = obj["nulls"].as<uint16_t>();
+  auto balance = obj["balance"].as<JsonArray>();
+  if (!balance.isNull()) {
+    for (size_t i = 0; i < out.balance.size() && i < balance.size(); ++i) {
+      out.balance[i] = balance[i].as<uint8_t>();
+    }
+  }
+}
+
+static void loadPatch(JsonObject obj, PatchConfig &patch) {
+  if (obj.containsKey("universe")) patch.universe = obj["universe"].as<uint16_t>();
+  if (obj.containsKey("address")) patch.startAddress = std::min<uint16_t>(std::max<uint16_t>(obj["address"].as<uint16_t>(), 1), 512);
+  if (obj.containsKey("wide")) patch.wide = obj["wide"].as<bool>();
+  JsonArray map = obj["map"].as<JsonArray>();
+  if (!map.isNull()) {
+    patch.mapCount = 0;
+    for (JsonVariant entry : map) {
+      if (patch.mapCount >= kMaxPatchMap) break;
+      patch.map[patch.mapCount++] = std::min<uint16_t>(entry.as<uint16_t>(), 512);
+    }
+  }
+}
+
+static void savePatch(JsonObject obj, const PatchConfig &patch) {
+  obj["universe"] = patch.universe;
+  obj["address"] = patch.startAddress;
+  obj["wide"] = patch.wide;
+  JsonArray map = obj.createNestedArray("map");
+  for (uint8_t i = 0; i < patch.mapCount; ++i) map.add(patch.map[i]);
+}
+
+static void loadDMXPort(JsonObject obj, DMXPortConfig &port) {
+  if (obj.containsKey("uart")) port.uart = obj["uart"].as<uint8_t>();
+  if (obj.containsKey("pin")) port.txPin = obj["pin"].as<uint8_t>();
+  loadPatch(obj, port.patch);
+  if (obj.containsKey("channels")) port.channels = obj["channels"].as<uint16_t>();
+  if (obj.containsKey("fps")) port.fps = obj["fps"].as<uint16_t>();
+  if (obj.containsKey("rdm")) port.rdm = obj["rdm"].as<bool>();
+  if (obj.containsKey("rxPin")) port.rxPin = obj["rxPin"].as<uint8_t>();
+  if (obj.containsKey("dirPin")) port.dirPin = obj["dirPin"].as<uint8_t>();
+}
+
 static bool loadJson(fs::FS &fs, const char *path, PrizmConfig &cfg) {
   File f = fs.open(path, "r");
   if (!f) {
@@ -24,7 +111,7 @@ static bool loadJson(fs::FS &fs, const char *path, PrizmConfig &cfg) {
     return false;
   }
 
-  DynamicJsonDocument doc(3072);
+  DynamicJsonDocument doc(8192);
   DeserializationError err = deserializeJson(doc, f);
   f.close();
   if (err) {
@@ -57,24 +144,69 @@ static bool loadJson(fs::FS &fs, const char *path, PrizmConfig &cfg) {
     if (e131.containsKey("count")) cfg.e131.universeCount = std::min<uint16_t>(e131["count"].as<uint16_t>(), kMaxUniverses);
     if (e131.containsKey("channels")) cfg.e131.channelsPerUniverse = e131["channels"].as<uint16_t>();
     if (e131.containsKey("priority")) cfg.e131.priority = e131["priority"].as<uint16_t>();
+    if (e131.containsKey("minPriority")) cfg.e131.minPriority = std::min<uint16_t>(e131["minPriority"].as<uint16_t>(), 200);
+    if (e131.containsKey("merge")) {
+      String mode = e131["merge"].as<const char*>();
+      cfg.e131.merge = mode == "ltp" ? MergeMode::LTP : MergeMode::HTP;
+    }
+    if (e131.containsKey("sourceTimeout")) cfg.e131.sourceTimeoutMs = e131["sourceTimeout"].as<uint32_t>();
+    if (e131.containsKey("sync")) cfg.e131.sync = e131["sync"].as<bool>();
+    if (e131.containsKey("syncTimeout")) cfg.e131.syncTimeoutMs = e131["syncTimeout"].as<uint32_t>();
+    if (e131.containsKey("protocol")) {
+      String protocol = e131["protocol"].as<const char*>();
+      if (protocol == "artnet") cfg.e131.protocol = InputProtocol::ArtNet;
+      else if (protocol == "both") cfg.e131.protocol = InputProtocol::Both;
+      else cfg.e131.protocol = InputProtocol::E131;
+    }
+    if (e131.containsKey("artnetUniverse")) cfg.e131.artnetUniverse = e131["artnetUniverse"].as<uint16_t>();
+    if (e131.containsKey("ddp")) cfg.e131.ddp = e131["ddp"].as<bool>();
   }
 
   auto pixels = root["pixels"].as<JsonObject>();
   if (!pixels.isNull()) {
     if (pixels.containsKey("enabled")) cfg.pixels.enabled = pixels["enabled"].as<bool>();
-    if (pixels.containsKey("count")) cfg.pixels.count = pixels["count"].as<uint16_t>();
-    if (pixels.containsKey("pin")) cfg.pixels.dataPin = pixels["pin"].as<uint8_t>();
     if (pixels.containsKey("brightness")) cfg.pixels.brightness = pixels["brightness"].as<uint8_t>();
-    if (pixels.containsKey("sk6812")) cfg.pixels.useWhiteChannel = pixels["sk6812"].as<bool>();
-    if (pixels.containsKey("grbw")) cfg.pixels.grbwOrder = pixels["grbw"].as<bool>();
+    if (pixels.containsKey("maxFps")) cfg.pixels.maxFps = pixels["maxFps"].as<uint16_t>();
+    if (pixels.containsKey("maxMa")) cfg.pixels.maxMilliamps = pixels["maxMa"].as<uint32_t>();
+    if (pixels.containsKey("maPerChannel")) cfg.pixels.milliampsPerChannel = pixels["maPerChannel"].as<uint8_t>();
+    if (pixels.containsKey("idleMa")) cfg.pixels.idleMilliamps = pixels["idleMa"].as<uint8_t>();
+
+    auto outputs = pixels["outputs"].as<JsonArray>();
+    if (!outputs.isNull()) {
+      cfg.pixels.outputCount = 0;
+      for (JsonObject out : outputs) {
+        if (cfg.pixels.outputCount >= kMaxPixelOutputs) break;
+        loadPixelOutput(out, cfg.pixels.outputs[cfg.pixels.outputCount++]);
+      }
+    } else {
+      loadPixelOutput(pixels, cfg.pixels.outputs[0]); // single-strip layout
+    }
   }
 
   auto dmx = root["dmx"].as<JsonObject>();
   if (!dmx.isNull()) {
     if (dmx.containsKey("enabled")) cfg.dmx.enabled = dmx["enabled"].as<bool>();
-    if (dmx.containsKey("channels")) cfg.dmx.channels = dmx["channels"].as<uint16_t>();
-    if (dmx.containsKey("pin")) cfg.dmx.txPin = dmx["pin"].as<uint8_t>();
-    if (dmx.containsKey("fps")) cfg.dmx.fps = dmx["fps"].as<uint16_t>();
+    auto ports = dmx["ports"].as<JsonArray>();
+    if (!ports.isNull()) {
+      cfg.dmx.portCount = 0;
+      for (JsonObject port : ports) {
+        if (cfg.dmx.portCount >= kMaxDMXPorts) break;
+        loadDMXPort(port, cfg.dmx.ports[cfg.dmx.portCount++]);
+      }
+    } else {
+      loadDMXPort(dmx, cfg.dmx.ports[0]); // single-port layout
+    }
+  }
+
+  auto dmxIn = root["dmxIn"].as<JsonObject>();
+  if (!dmxIn.isNull()) {
+    if (dmxIn.containsKey("enabled")) cfg.dmxIn.enabled = dmxIn["enabled"].as<bool>();
+    if (dmxIn.containsKey("uart")) cfg.dmxIn.uart = dmxIn["uart"].as<uint8_t>();
+    if (dmxIn.containsKey("pin")) cfg.dmxIn.rxPin = dmxIn["pin"].as<uint8_t>();
+    if (dmxIn.containsKey("universe")) cfg.dmxIn.universe = dmxIn["universe"].as<uint16_t>();
+    if (dmxIn.containsKey("priority")) cfg.dmxIn.priority = dmxIn["priority"].as<uint8_t>();
+    if (dmxIn.containsKey("merge")) cfg.dmxIn.merge = dmxIn["merge"].as<bool>();
+    if (dmxIn.containsKey("bridge")) cfg.dmxIn.bridge = dmxIn["bridge"].as<bool>();
   }
 
   auto servos = root["servos"].as<JsonObject>();
@@ -94,6 +226,8 @@ static bool loadJson(fs::FS &fs, const char *path, PrizmConfig &cfg) {
     if (servos.containsKey("max")) cfg.servos.maxServoAngle = servos["max"].as<float>();
     if (servos.containsKey("min")) cfg.servos.minServoAngle = servos["min"].as<float>();
     if (servos.containsKey("neutral")) cfg.servos.neutralAngle = servos["neutral"].as<float>();
+    auto patch = servos["patch"].as<JsonObject>();
+    if (!patch.isNull()) loadPatch(patch, cfg.servos.patch);
   }
 
   auto pots = root["pots"].as<JsonObject>();
@@ -131,6 +265,7 @@ static bool loadJson(fs::FS &fs, const char *path, PrizmConfig &cfg) {
     if (web.containsKey("enabled")) cfg.web.enabled = web["enabled"].as<bool>();
     if (web.containsKey("port")) cfg.web.port = web["port"].as<uint16_t>();
     if (web.containsKey("websocket")) cfg.web.websocket = web["websocket"].as<bool>();
+    if (web.containsKey("previewFps")) cfg.web.previewFps = web["previewFps"].as<uint8_t>();
   }
 
   auto failsafe = root["failsafe"].as<JsonObject>();
@@ -172,7 +307,7 @@ static void fillNetwork(JsonObject obj, const NetworkConfig &net) {
 }
 
 String toJsonString(const PrizmConfig &cfg, bool pretty) {
-  DynamicJsonDocument doc(3072);
+  DynamicJsonDocument doc(8192);
 
   fillNetwork(doc.createNestedObject("network"), cfg.network);
 
@@ -181,20 +316,72 @@ String toJsonString(const PrizmConfig &cfg, bool pretty) {
   e131["count"] = cfg.e131.universeCount;
   e131["channels"] = cfg.e131.channelsPerUniverse;
   e131["priority"] = cfg.e131.priority;
+  e131["minPriority"] = cfg.e131.minPriority;
+  e131["merge"] = cfg.e131.merge == MergeMode::LTP ? "ltp" : "htp";
+  e131["sourceTimeout"] = cfg.e131.sourceTimeoutMs;
+  e131["sync"] = cfg.e131.sync;
+  e131["syncTimeout"] = cfg.e131.syncTimeoutMs;
+  switch (cfg.e131.protocol) {
+    case InputProtocol::ArtNet: e131["protocol"] = "artnet"; break;
+    case InputProtocol::Both:   e131["protocol"] = "both"; break;
+    default:                    e131["protocol"] = "e131"; break;
+  }
+  e131["artnetUniverse"] = cfg.e131.artnetUniverse;
+  e131["ddp"] = cfg.e131.ddp;
 
   JsonObject pixels = doc.createNestedObject("pixels");
   pixels["enabled"] = cfg.pixels.enabled;
-  pixels["count"] = cfg.pixels.count;
-  pixels["pin"] = cfg.pixels.dataPin;
   pixels["brightness"] = cfg.pixels.brightness;
-  pixels["sk6812"] = cfg.pixels.useWhiteChannel;
-  pixels["grbw"] = cfg.pixels.grbwOrder;
+  pixels["maxFps"] = cfg.pixels.maxFps;
+  pixels["maxMa"] = cfg.pixels.maxMilliamps;
+  pixels["maPerChannel"] = cfg.pixels.milliampsPerChannel;
+  pixels["idleMa"] = cfg.pixels.idleMilliamps;
+  JsonArray outputs = pixels.createNestedArray("outputs");
+  for (uint8_t i = 0; i < cfg.pixels.outputCount; ++i) {
+    const PixelOutputConfig &src = cfg.pixels.outputs[i];
+    JsonObject out = outputs.createNestedObject();
+    out["pin"] = src.dataPin;
+    out["count"] = src.count;
+    out["chipset"] = src.chipset == PixelChipset::SK6812 ? "sk6812" : "ws2812b";
+    out["order"] = colorOrderName(src.order);
+    out["universe"] = src.startUniverse;
+    out["channel"] = src.startChannel;
+    out["gamma"] = src.gamma;
+    out["dither"] = src.dither;
+    out["16bit"] = src.input16;
+    out["reverse"] = src.reverse;
+    out["width"] = src.width;
+    out["serpentine"] = src.serpentine;
+    out["group"] = src.group;
+    out["nulls"] = src.nullPixels;
+    JsonArray balance = out.createNestedArray("balance");
+    for (uint8_t level : src.balance) balance.add(level);
+  }
 
   JsonObject dmx = doc.createNestedObject("dmx");
   dmx["enabled"] = cfg.dmx.enabled;
-  dmx["channels"] = cfg.dmx.channels;
-  dmx["pin"] = cfg.dmx.txPin;
-  dmx["fps"] = cfg.dmx.fps;
+  JsonArray ports = dmx.createNestedArray("ports");
+  for (uint8_t i = 0; i < cfg.dmx.portCount; ++i) {
+    const DMXPortConfig &src = cfg.dmx.ports[i];
+    JsonObject port = ports.createNestedObject();
+    port["uart"] = src.uart;
+    port["pin"] = src.txPin;
+    savePatch(port, src.patch);
+    port["channels"] = src.channels;
+    port["fps"] = src.fps;
+    port["rdm"] = src.rdm;
+    port["rxPin"] = src.rxPin;
+    port["dirPin"] = src.dirPin;
+  }
+
+  JsonObject dmxIn = doc.createNestedObject("dmxIn");
+  dmxIn["enabled"] = cfg.dmxIn.enabled;
+  dmxIn["uart"] = cfg.dmxIn.uart;
+  dmxIn["pin"] = cfg.dmxIn.rxPin;
+  dmxIn["universe"] = cfg.dmxIn.universe;
+  dmxIn["priority"] = cfg.dmxIn.priority;
+  dmxIn["merge"] = cfg.dmxIn.merge;
+  dmxIn["bridge"] = cfg.dmxIn.bridge;
 
   JsonObject servos = doc.createNestedObject("servos");
   servos["enabled"] = cfg.servos.enabled;
@@ -212,6 +399,7 @@ String toJsonString(const PrizmConfig &cfg, bool pretty) {
   servos["max"] = cfg.servos.maxServoAngle;
   servos["min"] = cfg.servos.minServoAngle;
   servos["neutral"] = cfg.servos.neutralAngle;
+  savePatch(servos.createNestedObject("patch"), cfg.servos.patch);
 
   JsonObject pots = doc.createNestedObject("pots");
   pots["brightness"] = cfg.pots.brightnessPin;
@@ -239,6 +427,7 @@ String toJsonString(const PrizmConfig &cfg, bool pretty) {
   web["enabled"] = cfg.web.enabled;
   web["port"] = cfg.web.port;
   web["websocket"] = cfg.web.websocket;
+  web["previewFps"] = cfg.web.previewFps;
 
   JsonObject failsafe = doc.createNestedObject("failsafe");
   failsafe["timeout"] = cfg.failsafe.timeoutMs;
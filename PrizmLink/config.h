@@ -23,9 +23,13 @@ constexpr uint16_t kDefaultChannelsPerUniverse = 512;
 constexpr bool     kDefaultMulticast = true;
 constexpr uint8_t  kDefaultPixelPin = 18;
 constexpr uint8_t  kDefaultPixelBrightness = 200;
+constexpr uint16_t kDefaultPixelFps = 60;
 constexpr uint8_t  kDefaultDMXPin = 17;
 constexpr uint16_t kDefaultDMXChannels = 128;
 constexpr uint16_t kDefaultDMXFps = 40;
+constexpr uint8_t  kNoPin = 0xFF;
+constexpr uint8_t  kDefaultDMXInPin = 16;
+constexpr uint8_t  kDefaultDMXInUart = 2;       // UART0 is the console, UART1 drives DMX out
 constexpr uint8_t  kDefaultJoystickSda = 9;
 constexpr uint8_t  kDefaultJoystickScl = 8;
 constexpr uint8_t  kDefaultJoystickInt = 7;
@@ -42,6 +46,9 @@ constexpr uint8_t  kDefaultOledAddr = 0x3C;
 constexpr uint8_t  kDefaultSDCs = 10;
 constexpr uint16_t kDefaultWebPort = 80;
 constexpr uint8_t  kMaxUniverses = 12;          // Safety cap (12 × 512 = 6144 channels)
+constexpr uint8_t  kMaxMergeSources = 4;        // sACN sources tracked per universe
+constexpr uint8_t  kMaxPixelOutputs = 4;        // ESP32-S3 has four RMT TX channels
+constexpr uint8_t  kMaxDMXPorts = 2;            // UART1 and UART2; UART0 is the console
 
 struct NetworkConfig {
   String ssid {"PrizmLink"};
@@ -56,27 +63,120 @@ struct NetworkConfig {
   bool multicast {kDefaultMulticast};
 };
 
+enum class MergeMode : uint8_t {
+  HTP,  // highest level per channel among equal-priority sources
+  LTP   // most recent packet among equal-priority sources
+};
+
+enum class InputProtocol : uint8_t {
+  E131,
+  ArtNet,
+  Both
+};
+
 struct E131Config {
   uint16_t startUniverse {kDefaultUniverse};
   uint16_t universeCount {kDefaultUniverses};
   uint16_t channelsPerUniverse {kDefaultChannelsPerUniverse};
   uint16_t priority {100};
+  uint8_t minPriority {0};       // sources below this priority are ignored
+  MergeMode merge {MergeMode::HTP};
+  uint32_t sourceTimeoutMs {2500};
+  bool sync {true};              // honour E1.31 universe synchronization
+  uint32_t syncTimeoutMs {2500}; // revert to unsynchronized latching after this
+  InputProtocol protocol {InputProtocol::E131};
+  uint16_t artnetUniverse {0};   // Art-Net port-address mapped to startUniverse
+  bool ddp {false};              // DDP on UDP 4048, offsets index the universe buffer
+};
+
+enum class PixelChipset : uint8_t {
+  WS2812B,
+  SK6812
+};
+
+enum class ColorOrder : uint8_t {
+  RGB,
+  RBG,
+  GRB,
+  GBR,
+  BRG,
+  BGR
+};
+
+struct PixelOutputConfig {
+  uint8_t dataPin {kDefaultPixelPin};
+  uint16_t count {kDefaultPixelCount};
+  PixelChipset chipset {PixelChipset::WS2812B}; // SK6812 = RGBW
+  ColorOrder order {ColorOrder::GRB};
+  uint16_t startUniverse {0};   // 0 = continue where the previous output ended
+  uint16_t startChannel {1};    // 1-based within startUniverse
+  float gamma {1.0f};           // 1.0 = linear, for consoles that already correct
+  std::array<uint8_t, 4> balance {255, 255, 255, 255}; // R, G, B, W white balance
+  bool dither {false};          // 16-bit pipeline with temporal dithering
+  bool input16 {false};         // coarse/fine channel pair per colour
+  bool reverse {false};
+  uint16_t width {0};           // matrix row length, 0 = single run
+  bool serpentine {false};      // alternate rows run backwards
+  uint8_t group {1};            // LEDs driven by each source pixel
+  uint16_t nullPixels {0};      // dark LEDs before the first mapped one
 };
 
 struct PixelConfig {
   bool enabled {true};
-  uint16_t count {kDefaultPixelCount};
-  uint8_t dataPin {kDefaultPixelPin};
   uint8_t brightness {kDefaultPixelBrightness};
-  bool useWhiteChannel {false}; // SK6812
-  bool grbwOrder {false};
+  uint16_t maxFps {kDefaultPixelFps}; // output frame clock, 0 = uncapped
+  uint32_t maxMilliamps {0};          // PSU budget for all outputs, 0 = no limit
+  uint8_t milliampsPerChannel {20};   // draw of one channel at full level
+  uint8_t idleMilliamps {1};          // per LED, all channels off
+  uint8_t outputCount {1};
+  std::array<PixelOutputConfig, kMaxPixelOutputs> outputs {};
 };
 
-struct DMXConfig {
-  bool enabled {true};
-  uint16_t channels {kDefaultDMXChannels};
+inline uint16_t totalPixels(const PixelConfig &cfg) {
+  uint16_t total = 0;
+  for (uint8_t i = 0; i < cfg.outputCount; ++i) total += cfg.outputs[i].count;
+  return total;
+}
+
+// Where a DMX consumer takes its channels from. Without a map, values are
+// consecutive from the start address; map entries pick each value's channel
+// counting from the start address (1 = start address, 0 = off). Wide values
+// are 16-bit coarse/fine pairs on two consecutive channels.
+constexpr uint8_t kMaxPatchMap = 64;
+
+struct PatchConfig {
+  uint16_t universe {0};                   // 0 = whichever universe arrived last
+  uint16_t startAddress {1};
+  bool wide {false};
+  uint8_t mapCount {0};
+  std::array<uint16_t, kMaxPatchMap> map {};
+};
+
+struct DMXPortConfig {
+  uint8_t uart {1};
   uint8_t txPin {kDefaultDMXPin};
+  PatchConfig patch;
+  uint16_t channels {kDefaultDMXChannels}; // footprint
   uint16_t fps {kDefaultDMXFps};
+  bool rdm {false};                        // RDM controller; needs rxPin and dirPin
+  uint8_t rxPin {kNoPin};
+  uint8_t dirPin {kNoPin};                 // transceiver DE/RE, high = transmit
+};
+
+struct DMXConfig {
+  bool enabled {true};
+  uint8_t portCount {1};
+  std::array<DMXPortConfig, kMaxDMXPorts> ports {};
+};
+
+struct DMXInputConfig {
+  bool enabled {false};
+  uint8_t uart {kDefaultDMXInUart};
+  uint8_t rxPin {kDefaultDMXInPin};
+  uint16_t universe {kDefaultUniverse}; // merged into / re-sent as this universe
+  uint8_t priority {100};               // as an sACN source in the merge
+  bool merge {true};                    // feed the output merge
+  bool bridge {false};                  // re-send as E1.31 multicast
 };
 
 struct ServoConfig {
@@ -95,6 +195,7 @@ struct ServoConfig {
   float maxServoAngle {180.0f};
   float minServoAngle {0.0f};
   float neutralAngle {90.0f};
+  PatchConfig patch;                       // one value per servo
 };
 
 struct PotConfig {
@@ -127,6 +228,7 @@ struct WebConfig {
   bool enabled {true};
   uint16_t port {kDefaultWebPort};
   bool websocket {true};
+  uint8_t previewFps {15};   // cap on the live pixel preview rate, 0 = disabled
 };
 
 struct FailsafeConfig {
@@ -141,6 +243,7 @@ struct PrizmConfig {
   E131Config e131;
   PixelConfig pixels;
   DMXConfig dmx;
+  DMXInputConfig dmxIn;
   ServoConfig servos;
   PotConfig pots;
   ButtonConfig buttons;
@@ -153,6 +256,21 @@ struct PrizmConfig {
 struct RuntimeStats {
   uint32_t lastPacketMs {0};
   uint32_t packetCounter {0};
+  uint32_t packetsStale {0};
+  uint32_t packetsDuplicate {0};
+  uint32_t packetsLost {0};
+  uint32_t frameOverruns {0};
+  uint16_t rxQueuePeak {0};
+  uint32_t artnetPackets {0};
+  uint32_t ddpPackets {0};
+  uint32_t pixelFramesBusy {0};
+  uint32_t pixelFramesDropped {0};
+  uint32_t pixelMilliamps {0};
+  bool pixelPowerLimited {false};
+  uint32_t dmxFrames {0};
+  uint32_t dmxMissed {0};
+  float dmxInFps {0.0f};
+  uint16_t dmxInSlots {0};
   float fps {0.0f};
   float cpu0Load {0.0f};
   float cpu1Load {0.0f};
@@ -0,0 +1,36 @@
+#include "ddp.h"
+
+namespace DDP {
+
+constexpr size_t kHeaderLength = 10;
+constexpr size_t kTimecodeLength = 4;
+
+constexpr uint8_t kVersionMask = 0xC0;
+constexpr uint8_t kVersion1 = 0x40;
+constexpr uint8_t kFlagTimecode = 0x10;
+constexpr uint8_t kFlagStorage = 0x08;
+constexpr uint8_t kFlagReply = 0x04;
+constexpr uint8_t kFlagQuery = 0x02;
+constexpr uint8_t kFlagPush = 0x01;
+
+bool parse(const uint8_t *data, size_t len, Packet &out) {
+  if (!data || len < kHeaderLength) return false;
+
+  uint8_t flags = data[0];
+  if ((flags & kVersionMask) != kVersion1) return false;
+  if (flags & (kFlagStorage | kFlagReply | kFlagQuery)) return false;
+
+  size_t header = kHeaderLength + ((flags & kFlagTimecode) ? kTimecodeLength : 0);
+  out.push = flags & kFlagPush;
+  out.sequence = data[1] & 0x0F;
+  out.dataType = data[2];
+  out.destination = data[3];
+  out.offset = (static_cast<uint32_t>(data[4]) << 24) | (static_cast<uint32_t>(data[5]) << 16) |
+               (static_cast<uint32_t>(data[6]) << 8) | data[7];
+  out.length = (data[8] << 8) | data[9];
+  if (len < header + out.length) return false;
+  out.data = &data[header];
+  return true;
+}
+
+} // namespace DDP
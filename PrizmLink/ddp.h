@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace DDP {
+
+constexpr uint16_t kPort = 4048;
+constexpr uint8_t kDefaultOutput = 1;
+constexpr uint8_t kAllDevices = 255;
+
+struct Packet {
+  bool push {false};         // latch everything received so far
+  uint8_t sequence {0};      // 4-bit, 0 = not used by the sender
+  uint8_t dataType {0};
+  uint8_t destination {0};
+  uint32_t offset {0};       // byte offset into the output buffer
+  uint16_t length {0};
+  const uint8_t *data {nullptr};
+};
+
+// Parses a DDP v1 data packet in place; `out.data` points into `data`.
+// Query, reply and storage packets are rejected.
+bool parse(const uint8_t *data, size_t len, Packet &out);
+
+} // namespace DDP
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "dmx_input.h"
+#include "debug_utils.h"
+#include "network_e131.h"
+#include <driver/uart.h>
+
+namespace DMXInput {
+
+static uart_port_t sPort = UART_NUM_2;
+static bool sReady = false;
+static QueueHandle_t sEvents = nullptr;
+static TaskHandle_t sRxTask = nullptr;
+
+// Frame assembly. Bytes are read in the order the driver reported them, so
+// everything before a break event belongs to the frame the break closes.
+// The UART also latches the break itself as one trailing null byte.
+static std::array<uint8_t, 514> sFrame;  // start code + 512 slots + break byte
+static size_t sLength = 0;
+static bool sSynced = false;             // a break has opened the current frame
+
+static std::atomic<uint32_t> sFrames {0};
+static std::atomic<uint32_t> sErrors {0};
+static std::atomic<uint16_t> sSlots {0};
+static std::atomic<float> sFps {0.0f};
+static uint32_t sWindowStartMs = 0;
+static uint32_t sWindowFrames = 0;
+
+constexpr BaseType_t kRxTaskCore = 0;         // Arduino loop() runs on core 1
+constexpr UBaseType_t kRxTaskPriority = 5;
+constexpr uint32_t kRxTaskStack = 3072;
+constexpr int kRxBufferSize = 1024;           // driver ring buffer, two frames deep
+constexpr int kEventQueueDepth = 32;
+
+static void readData(size_t available) {
+  while (available > 0) {
+    size_t room = sFrame.size() - sLength;
+    if (!sSynced || room == 0) {
+      if (sSynced) {
+        sErrors++; // longer than any DMX frame: wait for the next break
+        sSynced = false;
+      }
+      uint8_t scratch[64];
+      int n = uart_read_bytes(sPort, scratch, std::min(available, sizeof(scratch)), 0);
+      if (n <= 0) return;
+      available -= n;
+      continue;
+    }
+    int n = uart_read_bytes(sPort, sFrame.data() + sLength, std::min(available, room), 0);
+    if (n <= 0) return;
+    sLength += n;
+    available -= n;
+  }
+}
+
+static void closeFrame() {
+  if (sSynced && sLength >= 3 && sFrame[0] == 0x00) {
+    uint16_t slots = sLength - 2;
+    NetworkE131::submitLocal(sFrame.data() + 1, slots);
+    sSlots = slots;
+    sFrames++;
+    sWindowFrames++;
+  }
+
+  uint32_t now = millis();
+  if (now - sWindowStartMs >= 1000) {
+    sFps = (1000.0f * sWindowFrames) / (now - sWindowStartMs);
+    sWindowFrames = 0;
+    sWindowStartMs = now;
+  }
+  sLength = 0;
+  sSynced = true;
+}
+
+static void rxTask(void *) {
+  uart_event_t event;
+  for (;;) {
+    if (xQueueReceive(sEvents, &event, portMAX_DELAY) != pdTRUE) continue;
+    switch (event.type) {
+      case UART_DATA:
+        readData(event.size);
+        break;
+      case UART_BREAK:
+        closeFrame();
+        break;
+      case UART_FIFO_OVF:
+      case UART_BUFFER_FULL:
+        sErrors++;
+        uart_flush_input(sPort);
+        xQueueReset(sEvents);
+        sLength = 0;
+        sSynced = false;
+        break;
+      default:
+        break; // the break also raises a framing error
+    }
+  }
+}
+
+bool begin(const Prizm::DMXInputConfig &cfg) {
+  if (!cfg.enabled) {
+    sReady = false;
+    return false;
+  }
+  if (cfg.uart == UART_NUM_0 || cfg.uart >= UART_NUM_MAX) {
+    Debug::error("DMXIN", "UART %u not available", cfg.uart);
+    return false;
+  }
+  sPort = static_cast<uart_port_t>(cfg.uart);
+
+  uart_config_t uart_config = {
+      .baud_rate = 250000,
+      .data_bits = UART_DATA_8_BITS,
+      .parity = UART_PARITY_NONE,
+      .stop_bits = UART_STOP_BITS_2,
+      .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+      .source_clk = UART_SCLK_APB,
+  };
+
+  if (uart_param_config(sPort, &uart_config) != ESP_OK) {
+    Debug::error("DMXIN", "uart_param_config failed");
+    return false;
+  }
+
+  if (uart_set_pin(sPort, UART_PIN_NO_CHANGE, cfg.rxPin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) != ESP_OK) {
+    Debug::error("DMXIN", "uart_set_pin failed");
+    return false;
+  }
+
+  if (uart_driver_install(sPort, kRxBufferSize, 0, kEventQueueDepth, &sEvents, 0) != ESP_OK) {
+    Debug::error("DMXIN", "uart_driver_install failed");
+    return false;
+  }
+  // Move every slot out of the FIFO as it lands so it is reported ahead of
+  // the break that ends its frame.
+  uart_set_rx_full_threshold(sPort, 1);
+
+  sLength = 0;
+  sSynced = false;
+  sWindowStartMs = millis();
+  if (!sRxTask &&
+      xTaskCreatePinnedToCore(rxTask, "dmxRx", kRxTaskStack, nullptr, kRxTaskPriority,
+                              &sRxTask, kRxTaskCore) != pdPASS) {
+    sRxTask = nullptr;
+    Debug::error("DMXIN", "Receive task failed to start");
+    return false;
+  }
+  sReady = true;
+
+  Debug::info("DMXIN", "Listening on UART%u pin %u -> universe %u%s%s", cfg.uart, cfg.rxPin,
+              cfg.universe, cfg.merge ? " (merge)" : "", cfg.bridge ? " (bridge)" : "");
+  return true;
+}
+
+bool isReady() {
+  return sReady;
+}
+
+InputStats stats() {
+  InputStats out;
+  out.frames = sFrames;
+  out.errors = sErrors;
+  out.fps = sFps;
+  out.slots = sSlots;
+  return out;
+}
+
+} // namespace DMXInput
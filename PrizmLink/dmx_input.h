@@ -0,0 +1,23 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.h"
+
+namespace DMXInput {
+
+struct InputStats {
+  uint32_t frames {0};  // null start code frames received
+  uint32_t errors {0};  // overruns and over-length frames
+  float fps {0.0f};
+  uint16_t slots {0};   // slots in the last frame
+};
+
+// Receives DMX512 on DMXInputConfig::uart/rxPin. A task splits the byte
+// stream into frames on UART break events and hands each null start code
+// frame to NetworkE131::submitLocal() for merging and/or bridging.
+bool begin(const Prizm::DMXInputConfig &cfg);
+
+bool isReady();
+InputStats stats();
+
+} // namespace DMXInput
@@ -1,25 +1,185 @@
+#include <array>
+#include <atomic>
 #include <vector>
 #include <esp32/rom/ets_sys.h>
 #include <cstring>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include "dmx_output.h"
 #include "debug_utils.h"
+#include "rdm.h"
 #include <driver/uart.h>
 
 namespace DMXOutput {
 
-static const uart_port_t kDMXPort = UART_NUM_1;
+// DMX512-A transmitter timing: break >= 92 us, mark after break >= 12 us.
+constexpr uint32_t kBreakUs = 176;
+constexpr uint32_t kMabUs = 16;
+
+// RDM (E1.20) timing. A request plus the longest reply we read fits in the
+// slot; responders start replying within 2 ms of the request.
+constexpr uint32_t kRdmSlotUs = 7000;
+constexpr uint32_t kRdmResponseMs = 3;
+constexpr uint32_t kRdmTxTimeoutMs = 15;
+
+struct RdmExchange {
+  const uint8_t *request {nullptr};
+  size_t requestLength {0};
+  uint8_t *response {nullptr};
+  size_t responseCapacity {0};  // 0 = broadcast, nothing to listen for
+  bool discovery {false};       // DISC_UNIQUE_BRANCH: no break, fixed length
+  int responseLength {0};
+  TaskHandle_t waiter {nullptr};
+};
+
+// Each port owns its UART, buffers, refresh clock and transmit task.
+//
+// loop() → transmit task handoff, the same three-slot exchange the network
+// receiver uses: update() copies `buffer` into frames[writeIndex] and swaps
+// it into the middle slot; the task swaps the middle slot with its own
+// before each refresh. Neither side blocks and a refresh never tears.
+struct Port {
+  bool active {false};
+  uart_port_t uart {UART_NUM_1};
+  uint16_t channels {0};
+  uint32_t frameIntervalUs {25000};     // 40 FPS default
+  uint64_t lastFrameUs {0};             // loop() fallback schedule
+  TickType_t frameTicks {1};            // bound on waiting for the wire
+  std::vector<uint8_t> buffer;          // start code + payload, as last set by update()
+  std::array<std::vector<uint8_t>, 3> frames;
+  uint8_t writeIndex {0};
+  uint8_t readIndex {1};
+  std::atomic<uint8_t> middleIndex {2};
+  TaskHandle_t task {nullptr};
+  std::atomic<uint32_t> framesSent {0};
+  std::atomic<uint32_t> missed {0};
+  bool rdm {false};
+  uint8_t dirPin {Prizm::kNoPin};
+  std::atomic<RdmExchange*> exchange {nullptr};  // posted by rdmTransaction()
+};
+static std::array<Port, Prizm::kMaxDMXPorts> sPorts;
+static uint8_t sPortCount = 0;
 static bool sReady = false;
-static uint16_t sChannelCount = 0;
-static uint32_t sFrameIntervalUs = 25000; // 40 FPS default
-static uint32_t sLastFrameUs = 0;
-static std::vector<uint8_t> sBuffer;
 
-bool begin(const Prizm::DMXConfig &cfg) {
-  if (!cfg.enabled) {
-    Debug::warn("DMX", "Disabled via config");
-    sReady = false;
+constexpr uint8_t kFreshFrame = 0x80;
+constexpr uint8_t kFrameIndexMask = 0x03;
+
+constexpr BaseType_t kTxTaskCore = 0;         // Arduino loop() runs on core 1
+constexpr UBaseType_t kTxTaskPriority = 6;    // above the receive task, a late break is visible on the wire
+constexpr uint32_t kTxTaskStack = 2048;
+
+static void publish(Port &port) {
+  memcpy(port.frames[port.writeIndex].data(), port.buffer.data(), port.buffer.size());
+  uint8_t previous = port.middleIndex.exchange(port.writeIndex | kFreshFrame, std::memory_order_acq_rel);
+  port.writeIndex = previous & kFrameIndexMask;
+}
+
+// Break and MAB are timed by inverting the idle TX line for a cycle-counted
+// delay; the payload then goes out through the driver's TX ring buffer
+// without waiting for the wire.
+static void sendPacket(const Port &port, const uint8_t *data, size_t length) {
+  uart_set_line_inverse(port.uart, UART_SIGNAL_TXD_INV);
+  ets_delay_us(kBreakUs);
+  uart_set_line_inverse(port.uart, UART_SIGNAL_INV_DISABLE);
+  ets_delay_us(kMabUs);
+  uart_write_bytes(port.uart, data, length);
+}
+
+static void sendFrame(const Port &port, const uint8_t *frame) {
+  sendPacket(port, frame, port.channels + 1);
+}
+
+// Reads one reply with the transceiver turned around. Normal replies start
+// with a break, which the UART reports as a null byte, and carry their own
+// length; discovery replies are a fixed 24 bytes with no break.
+static int readResponse(const Port &port, uint8_t *out, size_t capacity, bool discovery) {
+  if (discovery) {
+    return std::max(uart_read_bytes(port.uart, out, std::min(capacity, RDM::kDiscoveryResponseLength),
+                                    pdMS_TO_TICKS(kRdmResponseMs + 1)), 0);
+  }
+
+  size_t n = 0;
+  size_t expected = 0;
+  uint8_t nulls = 0;
+  while (n < capacity && (expected == 0 || n < expected)) {
+    TickType_t wait = n == 0 ? pdMS_TO_TICKS(kRdmResponseMs) : pdMS_TO_TICKS(2);
+    if (uart_read_bytes(port.uart, out + n, 1, wait) <= 0) break;
+    if (n == 0 && out[0] == 0x00 && nulls++ < 2) continue;
+    if (++n == 3) expected = out[2] + 2;  // message length + checksum
+  }
+  return n;
+}
+
+static void runExchange(Port &port, RdmExchange &exchange) {
+  uart_flush_input(port.uart);
+  sendPacket(port, exchange.request, exchange.requestLength);
+  uart_wait_tx_done(port.uart, pdMS_TO_TICKS(kRdmTxTimeoutMs));
+  if (exchange.responseCapacity == 0) {
+    exchange.responseLength = 0;
+    return;
+  }
+  digitalWrite(port.dirPin, LOW);
+  exchange.responseLength = readResponse(port, exchange.response, exchange.responseCapacity,
+                                         exchange.discovery);
+  digitalWrite(port.dirPin, HIGH);
+}
+
+// RDM rides in the gap after a refresh: only once the frame has cleared the
+// wire and a whole exchange still fits before the next refresh is due, so
+// the DMX rate never drops for it.
+static void serviceRdm(Port &port, int64_t deadlineUs) {
+  if (!port.exchange.load(std::memory_order_acquire)) return;
+  if (uart_wait_tx_done(port.uart, port.frameTicks) != ESP_OK) return;
+  if (deadlineUs - esp_timer_get_time() < static_cast<int64_t>(kRdmSlotUs)) return;
+  RdmExchange *exchange = port.exchange.exchange(nullptr, std::memory_order_acq_rel);
+  if (!exchange) return;
+  runExchange(port, *exchange);
+  xTaskNotifyGive(exchange->waiter);
+}
+
+static void sendInline(const Port &port) {
+  uart_write_bytes_with_break(port.uart,
+                              reinterpret_cast<const char*>(port.buffer.data()),
+                              port.channels + 1,
+                              100); // 100us break
+}
+
+// Frames are scheduled from absolute tick deadlines. The interval is kept in
+// microseconds and each frame takes only the whole ticks out of it; the
+// remainder carries over, so 44 FPS alternates 22 and 23 ms frames and the
+// long-run rate is the configured one.
+static void txTask(void *arg) {
+  Port &port = *static_cast<Port*>(arg);
+  constexpr uint32_t kTickUs = portTICK_PERIOD_MS * 1000;
+  TickType_t wake = xTaskGetTickCount();
+  uint32_t carryUs = 0;
+  for (;;) {
+    carryUs += port.frameIntervalUs;
+    TickType_t ticks = carryUs / kTickUs;
+    carryUs -= ticks * kTickUs;
+    if (ticks > 0 && xTaskDelayUntil(&wake, ticks) == pdFALSE) port.missed++;
+    // The previous frame must be off the wire before the next break.
+    if (uart_wait_tx_done(port.uart, port.frameTicks) != ESP_OK) {
+      port.missed++;
+      continue;
+    }
+    if (port.middleIndex.load(std::memory_order_acquire) & kFreshFrame) {
+      uint8_t previous = port.middleIndex.exchange(port.readIndex, std::memory_order_acq_rel);
+      port.readIndex = previous & kFrameIndexMask;
+    }
+    int64_t frameStartUs = esp_timer_get_time();
+    sendFrame(port, port.frames[port.readIndex].data());
+    port.framesSent++;
+    if (port.rdm) serviceRdm(port, frameStartUs + port.frameIntervalUs);
+  }
+}
+
+static bool beginPort(Port &port, const Prizm::DMXPortConfig &cfg) {
+  if (cfg.uart == UART_NUM_0 || cfg.uart >= UART_NUM_MAX) {
+    Debug::error("DMX", "UART %u not available", cfg.uart);
     return false;
   }
+  port.uart = static_cast<uart_port_t>(cfg.uart);
 
   uart_config_t uart_config = {
       .baud_rate = 250000,
@@ -30,61 +190,163 @@ bool begin(const Prizm::DMXConfig &cfg) {
       .source_clk = UART_SCLK_APB,
   };
 
-  if (uart_param_config(kDMXPort, &uart_config) != ESP_OK) {
+  if (uart_param_config(port.uart, &uart_config) != ESP_OK) {
     Debug::error("DMX", "uart_param_config failed");
     return false;
   }
 
-  if (uart_set_pin(kDMXPort, cfg.txPin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) != ESP_OK) {
+  port.rdm = cfg.rdm && cfg.rxPin != Prizm::kNoPin && cfg.dirPin != Prizm::kNoPin;
+  if (cfg.rdm && !port.rdm) Debug::warn("DMX", "UART%u: RDM needs rxPin and dirPin", cfg.uart);
+  int rxPin = port.rdm ? cfg.rxPin : UART_PIN_NO_CHANGE;
+  if (uart_set_pin(port.uart, cfg.txPin, rxPin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) != ESP_OK) {
     Debug::error("DMX", "uart_set_pin failed");
     return false;
   }
 
-  if (uart_driver_install(kDMXPort, 1024, 0, 0, nullptr, 0) != ESP_OK) {
+  if (uart_driver_install(port.uart, 1024, 1024, 0, nullptr, 0) != ESP_OK) {
     Debug::error("DMX", "uart_driver_install failed");
     return false;
   }
 
-  sChannelCount = std::min<uint16_t>(cfg.channels, 512);
-  sBuffer.assign(sChannelCount + 1, 0); // start code + payload
-  sFrameIntervalUs = 1000000UL / std::max<uint16_t>(cfg.fps, 1);
-  sLastFrameUs = esp_timer_get_time();
-  sReady = true;
+  if (port.rdm) {
+    port.dirPin = cfg.dirPin;
+    pinMode(port.dirPin, OUTPUT);
+    digitalWrite(port.dirPin, HIGH);
+  }
+
+  port.channels = std::min<uint16_t>(cfg.channels, 512);
+  port.buffer.assign(port.channels + 1, 0); // start code + payload
+  for (auto &frame : port.frames) frame.assign(port.buffer.size(), 0);
+  port.frameIntervalUs = 1000000UL / std::max<uint16_t>(cfg.fps, 1);
+  port.frameTicks = std::max<TickType_t>(pdMS_TO_TICKS(port.frameIntervalUs / 1000), 1);
+  port.lastFrameUs = esp_timer_get_time();
+
+  uint32_t wireUs = kBreakUs + kMabUs + (port.channels + 1) * 44; // 11 bits per slot
+  if (port.rdm && port.frameIntervalUs < wireUs + kRdmSlotUs) {
+    Debug::warn("DMX", "UART%u: no RDM gap at %u FPS, lower fps or channels", cfg.uart, cfg.fps);
+  }
 
-  Debug::info("DMX", "Started (%u channels @ %u FPS)", sChannelCount, cfg.fps);
+  char name[8];
+  snprintf(name, sizeof(name), "dmxTx%u", cfg.uart);
+  if (!port.task &&
+      xTaskCreatePinnedToCore(txTask, name, kTxTaskStack, &port, kTxTaskPriority,
+                              &port.task, kTxTaskCore) != pdPASS) {
+    port.task = nullptr;
+    Debug::warn("DMX", "TX task failed to start, sending from loop()");
+  }
+
+  Debug::info("DMX", "UART%u started (%u channels @ %u FPS)", cfg.uart, port.channels, cfg.fps);
   return true;
 }
 
-void update(const uint8_t *data, size_t length) {
-  if (!sReady) return;
-  if (length > sChannelCount) length = sChannelCount;
-  memcpy(sBuffer.data() + 1, data, length);
+bool begin(const Prizm::DMXConfig &cfg) {
+  if (!cfg.enabled) {
+    Debug::warn("DMX", "Disabled via config");
+    sReady = false;
+    return false;
+  }
+
+  sPortCount = std::min(cfg.portCount, Prizm::kMaxDMXPorts);
+  sReady = false;
+  for (uint8_t i = 0; i < sPortCount; ++i) {
+    sPorts[i].active = beginPort(sPorts[i], cfg.ports[i]);
+    sReady |= sPorts[i].active;
+  }
+  return sReady;
+}
+
+void update(uint8_t port, const uint8_t *data, size_t length) {
+  if (!sReady || port >= sPortCount || !sPorts[port].active) return;
+  Port &p = sPorts[port];
+  if (length > p.channels) length = p.channels;
+  if (memcmp(p.buffer.data() + 1, data, length) == 0) return;
+  memcpy(p.buffer.data() + 1, data, length);
+  publish(p);
+}
+
+void update(uint8_t port, const uint8_t *source, size_t sourceLength, const uint16_t *index,
+            size_t count) {
+  if (!sReady || port >= sPortCount || !sPorts[port].active) return;
+  Port &p = sPorts[port];
+  if (count > p.channels) count = p.channels;
+  uint8_t *slots = p.buffer.data() + 1;
+  bool changed = false;
+  for (size_t i = 0; i < count; ++i) {
+    uint8_t level = index[i] < sourceLength ? source[index[i]] : 0;
+    changed |= slots[i] != level;
+    slots[i] = level;
+  }
+  if (changed) publish(p);
 }
 
+// Only drives the wire for ports whose TX task could not be started.
 void loop() {
   if (!sReady) return;
   uint64_t now = esp_timer_get_time();
-  if (now - sLastFrameUs < sFrameIntervalUs) return;
-  sLastFrameUs = now;
-
-  uart_write_bytes_with_break(kDMXPort,
-                              reinterpret_cast<const char*>(sBuffer.data()),
-                              sChannelCount + 1,
-                              100); // 100us break
+  for (uint8_t i = 0; i < sPortCount; ++i) {
+    Port &port = sPorts[i];
+    if (!port.active || port.task || now - port.lastFrameUs < port.frameIntervalUs) continue;
+    port.lastFrameUs += port.frameIntervalUs;
+    if (now - port.lastFrameUs >= port.frameIntervalUs) port.lastFrameUs = now; // fell behind, no burst
+    sendInline(port);
+    port.framesSent++;
+  }
 }
 
 void blackout() {
   if (!sReady) return;
-  memset(sBuffer.data() + 1, 0, sChannelCount);
-  uart_write_bytes_with_break(kDMXPort,
-                              reinterpret_cast<const char*>(sBuffer.data()),
-                              sChannelCount + 1,
-                              100);
+  for (uint8_t i = 0; i < sPortCount; ++i) {
+    Port &port = sPorts[i];
+    if (!port.active) continue;
+    memset(port.buffer.data() + 1, 0, port.channels);
+    publish(port);
+    if (!port.task) sendInline(port);
+  }
 }
 
 bool isReady() {
   return sReady;
 }
 
-} // namespace DMXOutput
+uint8_t portCount() {
+  return sPortCount;
+}
+
+bool rdmEnabled(uint8_t port) {
+  return port < sPortCount && sPorts[port].active && sPorts[port].rdm && sPorts[port].task;
+}
+
+int rdmTransaction(uint8_t port, const uint8_t *request, size_t length, uint8_t *response,
+                   size_t capacity, bool discovery, uint32_t timeoutMs) {
+  if (!rdmEnabled(port)) return -1;
+  Port &p = sPorts[port];
 
+  RdmExchange exchange;
+  exchange.request = request;
+  exchange.requestLength = length;
+  exchange.response = response;
+  exchange.responseCapacity = capacity;
+  exchange.discovery = discovery;
+  exchange.waiter = xTaskGetCurrentTaskHandle();
+
+  ulTaskNotifyTake(pdTRUE, 0);
+  RdmExchange *expected = nullptr;
+  if (!p.exchange.compare_exchange_strong(expected, &exchange)) return -1; // one caller at a time
+  if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeoutMs)) == 0) {
+    RdmExchange *mine = &exchange;
+    if (p.exchange.compare_exchange_strong(mine, nullptr)) return -1; // no gap came up
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // already on the wire, let it finish
+  }
+  return exchange.responseLength;
+}
+
+OutputStats stats() {
+  OutputStats out;
+  for (uint8_t i = 0; i < sPortCount; ++i) {
+    out.frames += sPorts[i].framesSent;
+    out.missed += sPorts[i].missed;
+  }
+  return out;
+}
+
+} // namespace DMXOutput
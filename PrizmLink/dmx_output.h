@@ -5,12 +5,37 @@
 
 namespace DMXOutput {
 
+struct OutputStats {
+  uint32_t frames {0};  // refreshes sent, all ports
+  uint32_t missed {0};  // refresh deadlines passed before the wire was free
+};
+
+// Starts each configured port's UART and a transmit task that refreshes it
+// at its own DMXPortConfig::fps with its own break/MAB timing. update() and
+// blackout() only hand a new buffer to the task; loop() sends inline only
+// for a port whose task could not be started. Port indices follow
+// DMXConfig::ports; a port that failed to start ignores updates.
 bool begin(const Prizm::DMXConfig &cfg);
 void loop();
-void update(const uint8_t *data, size_t length);
+void update(uint8_t port, const uint8_t *data, size_t length);
+// Gathers slot i from source[index[i]] directly into the port buffer; out of
+// range entries (DMXPatch::kUnpatched) send 0.
+void update(uint8_t port, const uint8_t *source, size_t sourceLength, const uint16_t *index,
+            size_t count);
 void blackout();
 
 bool isReady();
+uint8_t portCount();
+OutputStats stats();
+
+// Runs one RDM request on an RDM-enabled port in the gap after a DMX
+// refresh, blocking the calling task (never loop()) until it completes.
+// `capacity` 0 sends without listening. Returns the response length (0 for
+// no reply), or -1 if the port cannot do RDM or no gap came up within
+// `timeoutMs`.
+bool rdmEnabled(uint8_t port);
+int rdmTransaction(uint8_t port, const uint8_t *request, size_t length, uint8_t *response,
+                   size_t capacity, bool discovery, uint32_t timeoutMs);
 
 } // namespace DMXOutput
 
@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <array>
+#include <vector>
+#include "dmx_patch.h"
+#include "debug_utils.h"
+#include "network_e131.h"
+
+namespace DMXPatch {
+
+struct Table {
+  bool active {false};
+  uint16_t universe {0};
+  size_t offset {0};
+  uint8_t width {1};
+  size_t count {0};
+  std::vector<uint16_t> index;  // empty for straight patches
+};
+
+static std::array<Table, kConsumerCount> sTables;
+
+static void build(Table &table, const Prizm::PatchConfig &patch, size_t bytes) {
+  table.active = true;
+  table.universe = patch.universe;
+  table.offset = patch.startAddress - 1;
+  table.width = patch.wide ? 2 : 1;
+  table.index.clear();
+  if (patch.mapCount == 0) {
+    table.count = bytes;
+    return;
+  }
+
+  table.count = std::min<size_t>(bytes, patch.mapCount * table.width);
+  table.index.reserve(table.count);
+  for (size_t i = 0; i < table.count; ++i) {
+    uint16_t entry = patch.map[i / table.width];
+    size_t source = table.offset + entry - 1 + i % table.width;
+    table.index.push_back(entry != 0 && source < 512 ? static_cast<uint16_t>(source) : kUnpatched);
+  }
+}
+
+void compile(const Prizm::PrizmConfig &cfg) {
+  for (auto &table : sTables) table = Table();
+
+  if (cfg.dmx.enabled) {
+    for (uint8_t i = 0; i < std::min(cfg.dmx.portCount, Prizm::kMaxDMXPorts); ++i) {
+      const Prizm::DMXPortConfig &port = cfg.dmx.ports[i];
+      build(sTables[dmxPort(i)], port.patch, std::min<uint16_t>(port.channels, 512));
+    }
+  }
+  if (cfg.servos.enabled) {
+    const Prizm::PatchConfig &patch = cfg.servos.patch;
+    build(sTables[Servos], patch, kServoCount * (patch.wide ? 2 : 1));
+  }
+
+  for (uint8_t i = 0; i < kConsumerCount; ++i) {
+    const Table &table = sTables[i];
+    if (!table.active || table.index.empty()) continue;
+    Debug::info("PATCH", "Consumer %u: %u bytes remapped from universe %u", i,
+                static_cast<unsigned>(table.count), table.universe);
+  }
+}
+
+bool resolve(Consumer consumer, Route &route) {
+  if (consumer >= kConsumerCount) return false;
+  const Table &table = sTables[consumer];
+  if (!table.active) return false;
+
+  route.data = table.universe ? NetworkE131::universeData(table.universe, route.length)
+                              : NetworkE131::dmxData(route.length);
+  if (!route.data) return false;
+  route.offset = table.offset;
+  route.index = table.index.empty() ? nullptr : table.index.data();
+  route.count = table.count;
+  route.width = table.width;
+  return true;
+}
+
+uint16_t value16(const Route &route, size_t i, uint16_t fallback) {
+  size_t first = i * route.width;
+  if (!route.data || first >= route.count) return fallback;
+  size_t coarse = route.index ? route.index[first] : route.offset + first;
+  if (coarse == kUnpatched || coarse >= route.length) return fallback;
+  if (route.width == 1) return route.data[coarse] * 257;
+
+  size_t fine = route.index ? route.index[first + 1] : coarse + 1;
+  uint8_t fineLevel = fine < route.length ? route.data[fine] : 0;
+  return static_cast<uint16_t>(route.data[coarse] << 8 | fineLevel);
+}
+
+} // namespace DMXPatch
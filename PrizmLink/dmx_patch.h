@@ -0,0 +1,48 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.h"
+
+// Channel patch for everything that consumes DMX levels. Each consumer's
+// PatchConfig is compiled once into a byte index table; per frame a consumer
+// resolves its route and reads straight out of the receive buffer.
+namespace DMXPatch {
+
+enum Consumer : uint8_t {
+  DmxPort0,
+  DmxPort1,
+  Servos,
+  kConsumerCount
+};
+static_assert(DmxPort0 + Prizm::kMaxDMXPorts == Servos, "one consumer per DMX port");
+
+constexpr uint8_t kServoCount = 4;
+constexpr uint16_t kUnpatched = 0xFFFF;
+
+// A consumer's patch against the current frame. Straight patches read
+// `count` bytes in place from data + offset; remapped ones go through
+// `index`, one source offset per output byte.
+struct Route {
+  const uint8_t *data {nullptr};
+  size_t length {0};                // bytes received in the source universe
+  size_t offset {0};
+  const uint16_t *index {nullptr};  // null for straight patches
+  size_t count {0};                 // output bytes
+  uint8_t width {1};                // bytes per value
+};
+
+inline Consumer dmxPort(uint8_t port) {
+  return static_cast<Consumer>(DmxPort0 + port);
+}
+
+// Builds the index tables from the loaded config.
+void compile(const Prizm::PrizmConfig &cfg);
+
+// False when the consumer is unused or its universe has no data.
+bool resolve(Consumer consumer, Route &route);
+
+// Value `i` of a route as 16 bits; 8-bit values are scaled by 257. Values
+// that are unpatched or not received yet read as `fallback`.
+uint16_t value16(const Route &route, size_t i, uint16_t fallback);
+
+} // namespace DMXPatch
@@ -0,0 +1,223 @@
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include "e131_merge.h"
+#include "debug_utils.h"
+
+namespace E131Merge {
+
+constexpr size_t kCidLength = 16;
+
+struct Source {
+  uint8_t cid[kCidLength] {0};
+  uint8_t priority {0};
+  uint16_t length {0};
+  uint32_t lastSeenMs {0};
+  bool active {false};
+  bool stored {false}; // levels held in sSourceData rather than only in the slot
+  uint8_t sequence {0};
+};
+
+static Prizm::MergeMode sMode = Prizm::MergeMode::HTP;
+static uint32_t sTimeoutMs = 2500;
+static uint8_t sPriorityFloor = 0;
+static uint16_t sUniverseCount = 0;
+static uint16_t sChannels = 0;
+static std::vector<Source> sSources;      // universeCount × kMaxMergeSources
+static std::vector<uint8_t> sSourceData;  // one channel window per source entry
+
+static inline Source *slotSources(uint16_t slot) {
+  return &sSources[static_cast<size_t>(slot) * Prizm::kMaxMergeSources];
+}
+
+static inline uint8_t *sourceData(uint16_t slot, size_t index) {
+  size_t entry = static_cast<size_t>(slot) * Prizm::kMaxMergeSources + index;
+  return sSourceData.data() + entry * sChannels;
+}
+
+bool begin(const Prizm::E131Config &cfg, uint16_t universeCount, uint16_t channelsPerUniverse) {
+  sMode = cfg.merge;
+  sTimeoutMs = cfg.sourceTimeoutMs;
+  sPriorityFloor = std::min<uint8_t>(cfg.minPriority, 200);
+  sUniverseCount = universeCount;
+  sChannels = channelsPerUniverse;
+
+  sSources.assign(static_cast<size_t>(universeCount) * Prizm::kMaxMergeSources, Source{});
+  sSourceData.assign(sSources.size() * channelsPerUniverse, 0);
+
+  Debug::info("Merge", "%u sources/universe, %s, floor %u",
+              static_cast<unsigned>(Prizm::kMaxMergeSources),
+              sMode == Prizm::MergeMode::HTP ? "HTP" : "LTP", sPriorityFloor);
+  return true;
+}
+
+static void expire(Source *sources, uint32_t nowMs) {
+  for (size_t i = 0; i < Prizm::kMaxMergeSources; ++i) {
+    Source &src = sources[i];
+    if (src.active && nowMs - src.lastSeenMs >= sTimeoutMs) {
+      src.active = false;
+    }
+  }
+}
+
+static int findOrClaim(Source *sources, const uint8_t *cid, uint8_t priority) {
+  int freeIndex = -1;
+  int weakest = -1;
+  for (size_t i = 0; i < Prizm::kMaxMergeSources; ++i) {
+    Source &src = sources[i];
+    if (!src.active) {
+      if (freeIndex < 0) freeIndex = static_cast<int>(i);
+      continue;
+    }
+    if (memcmp(src.cid, cid, kCidLength) == 0) return static_cast<int>(i);
+    if (weakest < 0 || src.priority < sources[weakest].priority) weakest = static_cast<int>(i);
+  }
+  if (freeIndex >= 0) return freeIndex;
+  // Table full: only evict a source that this one would outrank anyway.
+  if (weakest >= 0 && sources[weakest].priority < priority) return weakest;
+  return -1;
+}
+
+static uint8_t topPriority(const Source *sources, uint8_t &contenders) {
+  uint8_t top = 0;
+  contenders = 0;
+  for (size_t i = 0; i < Prizm::kMaxMergeSources; ++i) {
+    if (!sources[i].active) continue;
+    if (contenders == 0 || sources[i].priority > top) {
+      top = sources[i].priority;
+      contenders = 1;
+    } else if (sources[i].priority == top) {
+      contenders++;
+    }
+  }
+  return top;
+}
+
+// Signed distance from `last` to `sequence`. Art-Net counts 1..255, so its
+// deltas are taken modulo 255 and 255 → 1 is one step.
+static int8_t sequenceDelta(uint8_t sequence, uint8_t last, Sequencing sequencing) {
+  if (sequencing != Sequencing::ArtNet) return static_cast<int8_t>(sequence - last);
+  int delta = (static_cast<int>(sequence) - last + 255) % 255;
+  return static_cast<int8_t>(delta > 127 ? delta - 255 : delta);
+}
+
+Claim claim(uint16_t slot, const uint8_t *cid, uint8_t priority, uint8_t sequence, uint32_t nowMs,
+            Sequencing sequencing) {
+  Claim result;
+  if (slot >= sUniverseCount || !cid) return result;
+  if (priority < sPriorityFloor) return result;
+
+  Source *sources = slotSources(slot);
+  expire(sources, nowMs);
+
+  int index = findOrClaim(sources, cid, priority);
+  if (index < 0) return result;
+
+  Source &self = sources[index];
+  bool ordered = sequencing != Sequencing::None;
+  if (self.active && ordered) {
+    // Deltas in (-20, 0] are late or repeated packets; anything further
+    // back is treated as the source restarting its sequence.
+    int8_t delta = sequenceDelta(sequence, self.sequence, sequencing);
+    if (sequencing == Sequencing::ArtNet && self.sequence == 0) delta = 1; // sequencing just turned on
+    if (delta == 0) {
+      result.verdict = Verdict::Duplicate;
+      return result;
+    }
+    if (delta < 0 && delta > -20) {
+      result.verdict = Verdict::Stale;
+      return result;
+    }
+    if (delta > 1) result.lost = delta - 1;
+  } else {
+    memcpy(self.cid, cid, kCidLength);
+    self.stored = false;
+  }
+  self.sequence = sequence;
+  self.priority = priority;
+  self.lastSeenMs = nowMs;
+  self.active = true;
+
+  uint8_t contenders = 0;
+  if (priority < topPriority(sources, contenders)) {
+    self.stored = false; // levels not kept while outranked
+    return result;
+  }
+  result.source = index;
+  result.verdict = Verdict::Accepted;
+  return result;
+}
+
+uint16_t merge(uint16_t slot, int source, const uint8_t *data, uint16_t length,
+               const uint8_t *current, uint16_t currentLength, uint8_t *out) {
+  if (slot >= sUniverseCount || source < 0 || !data || !current || !out) return currentLength;
+
+  Source *sources = slotSources(slot);
+  Source &self = sources[source];
+  self.length = std::min<uint16_t>(length, sChannels);
+
+  uint8_t contenders = 0;
+  uint8_t top = topPriority(sources, contenders);
+  if (contenders == 1 || sMode == Prizm::MergeMode::LTP) {
+    // Sole winner, or latest-takes-precedence: this packet is the newest
+    // data at the winning priority and goes straight into the slot.
+    memcpy(out, data, self.length);
+    self.stored = false;
+    return self.length;
+  }
+
+  // HTP between equal-priority sources needs every contender's levels. A
+  // source that was winning alone only ever wrote the slot, so seed its
+  // store from the slot before this packet overwrites it.
+  for (size_t i = 0; i < Prizm::kMaxMergeSources; ++i) {
+    Source &src = sources[i];
+    if (static_cast<int>(i) == source || !src.active || src.priority != top || src.stored) continue;
+    src.length = std::min(src.length, currentLength);
+    memcpy(sourceData(slot, i), current, src.length);
+    src.stored = true;
+  }
+  memcpy(sourceData(slot, source), data, self.length);
+  self.stored = true;
+
+  uint16_t merged = 0;
+  for (size_t i = 0; i < Prizm::kMaxMergeSources; ++i) {
+    const Source &src = sources[i];
+    if (!src.active || src.priority != top) continue;
+    const uint8_t *levels = sourceData(slot, i);
+    uint16_t overlap = std::min(merged, src.length);
+    if (merged == 0) {
+      memcpy(out, levels, src.length);
+    } else {
+      for (uint16_t ch = 0; ch < overlap; ++ch) {
+        out[ch] = std::max(out[ch], levels[ch]);
+      }
+      if (src.length > merged) {
+        memcpy(out + merged, levels + merged, src.length - merged);
+      }
+    }
+    merged = std::max(merged, src.length);
+  }
+  return merged;
+}
+
+void remove(uint16_t slot, const uint8_t *cid) {
+  if (slot >= sUniverseCount || !cid) return;
+  Source *sources = slotSources(slot);
+  for (size_t i = 0; i < Prizm::kMaxMergeSources; ++i) {
+    if (sources[i].active && memcmp(sources[i].cid, cid, kCidLength) == 0) {
+      sources[i].active = false;
+    }
+  }
+}
+
+uint8_t sourceCount(uint16_t slot) {
+  if (slot >= sUniverseCount) return 0;
+  const Source *sources = slotSources(slot);
+  uint8_t count = 0;
+  for (size_t i = 0; i < Prizm::kMaxMergeSources; ++i) {
+    if (sources[i].active) count++;
+  }
+  return count;
+}
+
+} // namespace E131Merge
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.h"
+
+namespace E131Merge {
+
+// Fixed-memory sACN source arbitration. Each universe slot tracks up to
+// Prizm::kMaxMergeSources senders by CID; the highest priority wins and
+// equal-priority sources are combined HTP or LTP per E131Config::merge.
+bool begin(const Prizm::E131Config &cfg, uint16_t universeCount, uint16_t channelsPerUniverse);
+
+enum class Verdict : uint8_t {
+  Accepted,
+  Outranked,  // below the floor, beaten by a live source, or table full
+  Stale,      // sequence went backwards (E1.31 §6.7.2)
+  Duplicate   // same sequence number as the last accepted packet
+};
+
+struct Claim {
+  int source {-1};   // handle for merge(), valid when Accepted
+  Verdict verdict {Verdict::Outranked};
+  uint8_t lost {0};  // sequence numbers skipped since this source's last packet
+};
+
+// How a source numbers its packets.
+enum class Sequencing : uint8_t {
+  None,    // no out-of-order check
+  E131,    // 0..255, 255 wraps to 0
+  ArtNet   // 1..255, 255 wraps to 1 (0 means the sender has sequencing off)
+};
+
+// Arbitration for one universe packet from `cid`. Runs the out-of-order
+// check against the source's last sequence number (unless `sequencing` is
+// None), refreshes its entry and returns a handle when the packet should
+// be applied.
+Claim claim(uint16_t slot, const uint8_t *cid, uint8_t priority, uint8_t sequence, uint32_t nowMs,
+            Sequencing sequencing = Sequencing::E131);
+
+// Applies an accepted claim's levels and writes the merged slot to `out`.
+// `current` holds the slot's latest merged levels (`currentLength` bytes)
+// and may alias `out`. A lone winner is copied straight from `data`, so the
+// common single-source case costs one copy. Returns the merged length.
+uint16_t merge(uint16_t slot, int source, const uint8_t *data, uint16_t length,
+               const uint8_t *current, uint16_t currentLength, uint8_t *out);
+
+// Forgets a source immediately (E1.31 Stream_Terminated option).
+void remove(uint16_t slot, const uint8_t *cid);
+
+uint8_t sourceCount(uint16_t slot);
+
+} // namespace E131Merge
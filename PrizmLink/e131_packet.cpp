@@ -0,0 +1,136 @@
+#include <cstring>
+#include "e131_packet.h"
+
+namespace E131Packet {
+
+// ACN root / E1.31 framing / DMP layer offsets (ANSI E1.31-2018 §4)
+constexpr size_t kRootVectorOffset = 18;
+constexpr size_t kCidOffset = 22;
+constexpr size_t kFramingFlagsOffset = 38;
+constexpr size_t kFramingVectorOffset = 40;
+constexpr size_t kPriorityOffset = 108;
+constexpr size_t kSyncAddressOffset = 109;
+constexpr size_t kSequenceOffset = 111;
+constexpr size_t kOptionsOffset = 112;
+constexpr size_t kUniverseOffset = 113;
+constexpr size_t kDmpOffset = 115;
+constexpr size_t kPropertyCountOffset = 123;
+constexpr size_t kStartCodeOffset = 125;
+constexpr size_t kMinPacketLength = 126;
+constexpr size_t kSyncPacketAddressOffset = 45;
+constexpr size_t kSyncPacketLength = 49;
+
+constexpr uint32_t kVectorRootE131Data = 0x00000004;
+constexpr uint32_t kVectorRootE131Extended = 0x00000008;
+constexpr uint32_t kVectorE131DataPacket = 0x00000002;
+constexpr uint32_t kVectorE131ExtendedSync = 0x00000001;
+
+static const char kAcnPacketId[12] = {'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0};
+
+static inline uint16_t readU16(const uint8_t *p) {
+  return (static_cast<uint16_t>(p[0]) << 8) | p[1];
+}
+
+static inline void writeU16(uint8_t *p, uint16_t value) {
+  p[0] = value >> 8;
+  p[1] = value & 0xFF;
+}
+
+static inline void writeU32(uint8_t *p, uint32_t value) {
+  writeU16(p, value >> 16);
+  writeU16(p + 2, value & 0xFFFF);
+}
+
+static inline uint32_t readU32(const uint8_t *p) {
+  return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+         (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+static bool hasE131Header(const uint8_t *data, size_t len) {
+  if (!data || len < kSyncPacketLength) return false;
+  if (readU16(&data[0]) != 0x0010) return false; // preamble size
+  if (memcmp(&data[4], kAcnPacketId, sizeof(kAcnPacketId)) != 0) return false;
+
+  uint16_t rootFlagsLength = readU16(&data[16]);
+  if ((rootFlagsLength & 0x0FFF) + 16u > len) return false; // truncated datagram
+
+  uint16_t framingFlagsLength = readU16(&data[kFramingFlagsOffset]);
+  return (framingFlagsLength & 0x7000) == 0x7000;
+}
+
+View parse(const uint8_t *data, size_t len) {
+  View view;
+  if (!hasE131Header(data, len)) return view;
+
+  uint32_t rootVector = readU32(&data[kRootVectorOffset]);
+  uint32_t framingVector = readU32(&data[kFramingVectorOffset]);
+
+  if (rootVector == kVectorRootE131Extended && framingVector == kVectorE131ExtendedSync) {
+    view.cid = &data[kCidOffset];
+    view.syncAddress = readU16(&data[kSyncPacketAddressOffset]);
+    if (view.syncAddress != 0 && view.syncAddress <= kMaxUniverse) view.kind = Kind::Sync;
+    return view;
+  }
+
+  if (len < kMinPacketLength) return view; // minimal root + framing + DMP headers
+  if (rootVector != kVectorRootE131Data || framingVector != kVectorE131DataPacket) return view;
+
+  uint8_t options = data[kOptionsOffset];
+  if (options & kOptionPreviewData) return view;
+
+  const uint8_t *dmp = &data[kDmpOffset];
+  if (dmp[2] != 0x02) return view;  // DMP set property
+  if (dmp[3] != 0xa1) return view;  // address + data type
+
+  uint16_t propValCount = readU16(&data[kPropertyCountOffset]);
+  if (propValCount < 2 || propValCount > 513) return view;
+  if (len < kStartCodeOffset + propValCount) return view;
+  if (data[kStartCodeOffset] != 0x00) return view; // only null start code carries levels
+
+  uint16_t universe = readU16(&data[kUniverseOffset]);
+  if (universe == 0 || universe > kMaxUniverse) return view;
+
+  view.kind = Kind::Data;
+  view.cid = &data[kCidOffset];
+  view.universe = universe;
+  view.syncAddress = readU16(&data[kSyncAddressOffset]);
+  view.sequence = data[kSequenceOffset];
+  view.priority = data[kPriorityOffset];
+  view.options = options;
+  view.levels = &data[kStartCodeOffset + 1];
+  view.length = propValCount - 1; // first is DMX start code
+  return view;
+}
+
+size_t buildData(uint8_t *out, size_t capacity, const Source &source, uint16_t universe,
+                 uint8_t sequence, const uint8_t *levels, uint16_t count) {
+  size_t len = kStartCodeOffset + 1 + count;
+  if (count > 512 || capacity < len || !source.cid) return 0;
+  memset(out, 0, kStartCodeOffset + 1);
+
+  // Root layer
+  writeU16(&out[0], 0x0010);
+  memcpy(&out[4], kAcnPacketId, sizeof(kAcnPacketId));
+  writeU16(&out[16], 0x7000 | (len - 16));
+  writeU32(&out[kRootVectorOffset], kVectorRootE131Data);
+  memcpy(&out[kCidOffset], source.cid, 16);
+
+  // Framing layer
+  writeU16(&out[kFramingFlagsOffset], 0x7000 | (len - kFramingFlagsOffset));
+  writeU32(&out[kFramingVectorOffset], kVectorE131DataPacket);
+  strncpy(reinterpret_cast<char*>(&out[44]), source.name, 63);
+  out[kPriorityOffset] = source.priority;
+  out[kSequenceOffset] = sequence;
+  writeU16(&out[kUniverseOffset], universe);
+
+  // DMP layer
+  writeU16(&out[kDmpOffset], 0x7000 | (len - kDmpOffset));
+  out[kDmpOffset + 2] = 0x02;
+  out[kDmpOffset + 3] = 0xa1;
+  writeU16(&out[kDmpOffset + 6], 0x0001);  // address increment
+  writeU16(&out[kPropertyCountOffset], count + 1);
+  memcpy(&out[kStartCodeOffset + 1], levels, count);
+  return len;
+}
+
+} // namespace E131Packet
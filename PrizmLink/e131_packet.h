@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// E1.31 (sACN) packet parsing with no Arduino or lwIP dependency, so it can
+// be compiled and exercised off-device. Nothing is copied or allocated: the
+// returned view points into the caller's datagram.
+namespace E131Packet {
+
+constexpr uint16_t kPort = 5568;
+constexpr uint16_t kMaxUniverse = 63999;  // 0 and 64000+ are reserved
+
+constexpr uint8_t kOptionPreviewData = 0x80;
+constexpr uint8_t kOptionStreamTerminated = 0x40;
+constexpr uint8_t kOptionForceSync = 0x20;
+
+enum class Kind : uint8_t {
+  Invalid,
+  Data,
+  Sync
+};
+
+struct View {
+  Kind kind {Kind::Invalid};
+  const uint8_t *cid {nullptr};     // 16 bytes
+  uint16_t universe {0};
+  uint16_t syncAddress {0};         // Sync: the universe being synchronized
+  uint8_t sequence {0};
+  uint8_t priority {0};
+  uint8_t options {0};
+  const uint8_t *levels {nullptr};  // Data: slot 1 onwards, start code stripped
+  uint16_t length {0};
+};
+
+// Validates root, framing and DMP layers of a data or sync packet. Preview
+// data, non-zero start codes, reserved universes and PDU lengths that run
+// past the datagram come back as Kind::Invalid.
+View parse(const uint8_t *data, size_t len);
+
+constexpr size_t kDataHeaderLength = 126;      // headers + start code, levels follow
+constexpr size_t kMaxDataPacketLength = kDataHeaderLength + 512;
+
+struct Source {
+  const uint8_t *cid {nullptr};     // 16 bytes
+  const char *name {""};            // truncated to 63 characters
+  uint8_t priority {100};
+};
+
+// Writes a data packet carrying `count` levels after a null start code.
+// Returns the packet length, or 0 if `count` exceeds 512 or `out` is short.
+size_t buildData(uint8_t *out, size_t capacity, const Source &source, uint16_t universe,
+                 uint8_t sequence, const uint8_t *levels, uint16_t count);
+
+} // namespace E131Packet
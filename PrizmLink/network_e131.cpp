@@ -1,72 +1,407 @@
 #include <cstring>
 #include <algorithm>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <lwip/api.h>
 #include "network_e131.h"
+#include "e131_merge.h"
+#include "e131_packet.h"
+#include "artnet.h"
+#include "ddp.h"
 #include "debug_utils.h"
 
 namespace NetworkE131 {
 
-static WiFiUDP sUdp;
+static struct netconn *sConn = nullptr;     // E1.31, port 5568
+static struct netconn *sArtConn = nullptr;  // Art-Net, port 6454
+static struct netconn *sDdpConn = nullptr;  // DDP, port 4048
+static struct netconn *sBridgeConn = nullptr; // E1.31 out, local DMX input
 static bool sWiFiConnected = false;
-static bool sActive = false;
+static uint8_t sLocalIp[4] {0};
+static uint8_t sLocalMac[6] {0};
+static String sHostname;
+static std::atomic<bool> sActive {false};
 static bool sManualOverride = false;
-static uint32_t sLastPacketMs = 0;
-static uint32_t sPacketCounter = 0;
+static std::atomic<uint32_t> sLastPacketMs {0};
+static uint32_t sFrameCounter = 0;
 static uint32_t sLastFpsUpdateMs = 0;
-static float sFps = 0.0f;
+static std::atomic<float> sFps {0.0f};
+static uint32_t sFailsafeTimeoutMs = 5000;
 static uint16_t sUniverseBase = 0;
 static uint16_t sUniverseCount = 0;
-static std::vector<uint8_t> sPixelBuffer;
-static std::vector<uint8_t> sDMXBuffer;
+static uint16_t sChannelsPerUniverse = 0;
+static size_t sSlotBytes = 0;            // universes × channels in use
+static FrameLayout sLayout {};
 static PacketInfo sLastPacketInfo {};
+static PacketStats sPacketStats {};
+static portMUX_TYPE sStatsMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Receive task → output handoff. Packets are merged straight into the slot
+// storage of sFrames[sWriteIndex]; latching swaps it with the middle slot and
+// takeFrame() swaps the middle slot with sFrames[sReadIndex]. Neither side
+// blocks and the reader always gets the newest complete frame. Pixels and
+// DMX are both views onto the same slot storage. Slot storage is sized for
+// kMaxUniverses once and never resized; each frame carries the layout it
+// was assembled in, so the reader never looks at receive-task state.
+struct Frame {
+  std::vector<uint8_t> slots;
+  FrameLayout layout;
+  size_t pixelLength {0};
+  size_t dmxOffset {0};
+  size_t dmxLength {0};
+  std::array<uint16_t, Prizm::kMaxUniverses> lengths {};  // per slot, for universeData()
+};
+static std::array<Frame, 3> sFrames;
+static uint8_t sWriteIndex = 0;
+static int8_t sPublishedIndex = -1;   // last frame handed over, for carry-forward
+static uint8_t sReadIndex = 1;
+static std::atomic<uint8_t> sMiddleIndex {2};
+constexpr uint8_t kFreshFrame = 0x80;
+constexpr uint8_t kFrameIndexMask = 0x03;
+
+static TaskHandle_t sRxTask = nullptr;
+constexpr BaseType_t kRxTaskCore = 0;         // Arduino loop() runs on core 1
+constexpr UBaseType_t kRxTaskPriority = 5;
+constexpr uint32_t kRxTaskStack = 4096;
+constexpr int kRxWaitMs = 20;               // housekeeping cadence while idle
+
+// Datagrams are parsed in place in the lwIP pbuf; the scratch copy is only
+// needed when the stack hands us a chained pbuf.
+constexpr size_t kMaxPacketLength = 1472;   // largest DDP datagram in one Ethernet frame
+static std::array<uint8_t, kMaxPacketLength> sScratch;
+
+// Universe → slot table. Each configured universe owns a fixed
+// channelsPerUniverse-sized window of the frame buffers so multi-universe
+// frames assemble side by side instead of overwriting offset 0.
+struct UniverseSlot {
+  uint16_t universe {0};
+  size_t offset {0};
+  uint16_t length {0};
+  uint32_t packets {0};
+};
+static std::array<UniverseSlot, Prizm::kMaxUniverses> sSlots {};
+static uint32_t sCompleteMask = 0;
+static uint32_t sReceivedMask = 0;
+static uint16_t sLastSlot = 0;
+
+// Universe synchronization (E1.31 §6.6). While a source tags its data with
+// a sync address we hold it in the write frame and only latch on the matching
+// sync packet; if sync packets stop we revert to per-frame latching.
+static bool sSyncEnabled = true;
+static uint32_t sSyncTimeoutMs = 2500;
+static uint16_t sSyncAddress = 0;
+static bool sSyncLocked = false;
+static uint32_t sLastSyncMs = 0;
+
+// Art-Net has no sync address on ArtDmx; seeing ArtSync switches every
+// source to synchronous mode under a pseudo address outside the E1.31 range.
+constexpr uint16_t kMaxE131Universe = 63999;
+constexpr uint16_t kArtSyncAddress = 0xFFFF;
+constexpr uint8_t kArtNetPriority = 100;    // E1.31 default, Art-Net carries none
+static uint16_t sArtNetBase = 0;
+static uint32_t sLastArtSyncMs = 0;
+static bool sArtSyncSeen = false;
+
+// DDP addresses the frame as one flat byte buffer. Each frame records the
+// spans it wrote (sorted, adjacent writes coalesced) so publishFrame()
+// carries forward only the rest; a sender that never sets PUSH is latched
+// on every packet.
+struct DdpSpan {
+  size_t begin {0};
+  size_t end {0};
+};
+constexpr uint8_t kMaxDdpSpans = 8;
+static std::array<DdpSpan, kMaxDdpSpans> sDdpSpans {};
+static uint8_t sDdpSpanCount = 0;
+static size_t sDdpLength = 0;
+static bool sDdpPushSeen = false;
+
+// IGMP memberships held on sConn: one group per configured universe plus
+// the sync universe a source is following. Kept in step with the slot table
+// and sync state by updateGroups().
+static std::array<uint16_t, Prizm::kMaxUniverses + 1> sGroups {};
+static uint8_t sGroupCount = 0;
+static bool sMulticast = false;
+static uint32_t sSyncPackets = 0;
+
+// Universe config handed over by reconfigure(), applied by the receive side
+// between socket passes so the slot table never changes under a packet.
+static Prizm::E131Config sPendingConfig {};
+static std::atomic<bool> sReconfigurePending {false};
+
+// Local DMX input. submitLocal() copies the frame in under sStatsMux from
+// the input task; the receive task merges it as one more source under a
+// pseudo-CID built from the MAC and/or re-sends it as E1.31 with that CID.
+// Both share one sequence counter, so a bridged packet looped back to our
+// own socket is rejected as a duplicate.
+static Prizm::DMXInputConfig sLocalCfg {};
+static std::array<uint8_t, 512> sLocalLevels {};
+static uint16_t sLocalLength = 0;
+static std::atomic<bool> sLocalPending {false};
+static std::array<uint8_t, 16> sLocalCid {'P', 'r', 'i', 'z', 'm', 'D', 'M', 'X', 'i', 'n'};
+static uint8_t sLocalSequence = 0;
+
+static void buildSlotTable(const Prizm::E131Config &cfg) {
+  sUniverseBase = cfg.startUniverse;
+  sUniverseCount = std::min<uint16_t>(cfg.universeCount, Prizm::kMaxUniverses);
+  sChannelsPerUniverse = std::min<uint16_t>(std::max<uint16_t>(cfg.channelsPerUniverse, 1), 512);
+  sSlotBytes = static_cast<size_t>(sUniverseCount) * sChannelsPerUniverse;
+  sLayout.startUniverse = sUniverseBase;
+  sLayout.universeCount = sUniverseCount;
+  sLayout.channelsPerUniverse = sChannelsPerUniverse;
+  sLayout.generation++;
+
+  sSlots.fill(UniverseSlot{});
+  for (uint16_t i = 0; i < sUniverseCount; ++i) {
+    sSlots[i].universe = sUniverseBase + i;
+    sSlots[i].offset = static_cast<size_t>(i) * sChannelsPerUniverse;
+  }
+  sCompleteMask = sUniverseCount >= 32 ? UINT32_MAX : ((1UL << sUniverseCount) - 1);
+  sReceivedMask = 0;
+
+  sSyncEnabled = cfg.sync;
+  sSyncTimeoutMs = cfg.syncTimeoutMs;
+  sSyncAddress = 0;
+  sSyncLocked = false;
+  sArtNetBase = cfg.artnetUniverse & 0x7FFF;
+  sArtSyncSeen = false;
+  sDdpSpanCount = 0;
+  sDdpLength = 0;
+}
+
+static void addDdpSpan(size_t begin, size_t end) {
+  uint8_t i = 0;
+  while (i < sDdpSpanCount && sDdpSpans[i].end < begin) ++i;
+  if (i < sDdpSpanCount && sDdpSpans[i].begin <= end) {
+    // Overlaps or touches span i; absorb any later spans it now reaches.
+    DdpSpan &span = sDdpSpans[i];
+    span.begin = std::min(span.begin, begin);
+    span.end = std::max(span.end, end);
+    uint8_t next = i + 1;
+    while (next < sDdpSpanCount && sDdpSpans[next].begin <= span.end) {
+      span.end = std::max(span.end, sDdpSpans[next].end);
+      ++next;
+    }
+    std::copy(sDdpSpans.begin() + next, sDdpSpans.begin() + sDdpSpanCount, sDdpSpans.begin() + i + 1);
+    sDdpSpanCount -= next - (i + 1);
+    return;
+  }
+  if (sDdpSpanCount == kMaxDdpSpans) {
+    // Out of spans: widen the nearest one. The gap it swallows is not
+    // carried forward this frame.
+    DdpSpan &span = sDdpSpans[i == sDdpSpanCount ? i - 1 : i];
+    span.begin = std::min(span.begin, begin);
+    span.end = std::max(span.end, end);
+    return;
+  }
+  std::copy_backward(sDdpSpans.begin() + i, sDdpSpans.begin() + sDdpSpanCount,
+                     sDdpSpans.begin() + sDdpSpanCount + 1);
+  sDdpSpans[i] = DdpSpan{begin, end};
+  sDdpSpanCount++;
+}
+
+// Copies [begin, end) from `latest` into `frame`, skipping DDP spans.
+static void carryForward(Frame &frame, const Frame &latest, size_t begin, size_t end) {
+  for (uint8_t i = 0; i < sDdpSpanCount && begin < end; ++i) {
+    const DdpSpan &span = sDdpSpans[i];
+    if (span.end <= begin) continue;
+    if (span.begin >= end) break;
+    if (span.begin > begin) {
+      memcpy(frame.slots.data() + begin, latest.slots.data() + begin, span.begin - begin);
+    }
+    begin = span.end;
+  }
+  if (begin < end) {
+    memcpy(frame.slots.data() + begin, latest.slots.data() + begin, end - begin);
+  }
+}
 
-constexpr uint16_t kE131Port = 5568;
+static void publishFrame() {
+  Frame &frame = sFrames[sWriteIndex];
+
+  // Universes that did not arrive this frame still hold data from an older
+  // frame in this buffer; bring just those slots forward, minus whatever DDP
+  // wrote. Once DDP is in use it may have written any part of a window.
+  if (sPublishedIndex >= 0) {
+    const Frame &latest = sFrames[sPublishedIndex];
+    for (uint16_t i = 0; i < sUniverseCount; ++i) {
+      if (sReceivedMask & (1UL << i)) continue;
+      size_t length = sDdpLength > 0 ? sChannelsPerUniverse : sSlots[i].length;
+      if (length == 0) continue;
+      carryForward(frame, latest, sSlots[i].offset, sSlots[i].offset + length);
+    }
+  }
 
-static bool isValidE131(const uint8_t *data, size_t len, PacketInfo &info) {
-  if (len < 126) return false; // minimal root + framing + DMP headers
+  frame.layout = sLayout;
+  frame.pixelLength = sDdpLength;
+  for (uint16_t i = 0; i < sUniverseCount; ++i) {
+    if (sSlots[i].length == 0) continue;
+    frame.pixelLength = std::max(frame.pixelLength, sSlots[i].offset + sSlots[i].length);
+  }
+  for (uint16_t i = 0; i < sUniverseCount; ++i) {
+    frame.lengths[i] = sSlots[i].length;
+  }
+  const UniverseSlot &dmxSlot = sSlots[sLastSlot];
+  frame.dmxOffset = dmxSlot.offset;
+  frame.dmxLength = dmxSlot.length;
+
+  sPublishedIndex = sWriteIndex;
+  uint8_t previous = sMiddleIndex.exchange(sWriteIndex | kFreshFrame, std::memory_order_acq_rel);
+  if (previous & kFreshFrame) {
+    portENTER_CRITICAL(&sStatsMux);
+    sPacketStats.overruns++; // reader never picked up the last frame
+    portEXIT_CRITICAL(&sStatsMux);
+  }
+  sWriteIndex = previous & kFrameIndexMask;
 
-  uint16_t preamble = (data[0] << 8) | data[1];
-  if (preamble != 0x0010) return false;
+  sFrameCounter++;
+  sReceivedMask = 0;
+  sDdpSpanCount = 0;
+}
 
-  const char *cid = reinterpret_cast<const char*>(&data[4]);
-  if (strncmp(cid, "ASC-E1.17", 9) != 0) return false;
+static bool syncHeld(uint32_t now) {
+  if (!sSyncLocked) return false;
+  if (now - sLastSyncMs < sSyncTimeoutMs) return true;
+  if (sLastPacketInfo.options & E131Packet::kOptionForceSync) return true; // source asked us to hold
 
-  uint16_t framingFlagsLength = (data[38] << 8) | data[39];
-  if ((framingFlagsLength & 0x7000) != 0x7000) return false;
+  Debug::warn("E131", "Sync %u lost, latching per frame", sSyncAddress);
+  sSyncLocked = false;
+  if (sReceivedMask != 0) {
+    publishFrame(); // release data held back for the missing sync
+  }
+  return false;
+}
 
-  uint16_t vector = (data[40] << 8) | data[41];
-  if (vector != 0x00002) return false; // E1.31 Data Packet
+static bool setMembership(uint16_t universe, bool join) {
+  ip_addr_t group;
+  IP_ADDR4(&group, 239, 255, (universe >> 8) & 0xFF, universe & 0xFF);
+  return netconn_join_leave_group(sConn, &group, IP_ADDR_ANY,
+                                  join ? NETCONN_JOIN : NETCONN_LEAVE) == ERR_OK;
+}
 
-  uint16_t universe = (data[113] << 8) | data[114];
-  info.universe = universe;
+static bool wantsGroup(uint16_t universe) {
+  if (universe >= sUniverseBase && universe < sUniverseBase + sUniverseCount) return true;
+  return universe != 0 && universe <= kMaxE131Universe && universe == sSyncAddress;
+}
 
-  uint8_t sequence = data[111];
-  info.sequence = sequence;
+static void ensureGroup(uint16_t universe) {
+  for (uint8_t i = 0; i < sGroupCount; ++i) {
+    if (sGroups[i] == universe) return;
+  }
+  if (sGroupCount >= sGroups.size()) return;
+  if (!setMembership(universe, true)) {
+    // lwIP caps memberships per netif (MEMP_NUM_IGMP_GROUP)
+    Debug::warn("E131", "Multicast join failed for universe %u", universe);
+    return;
+  }
+  sGroups[sGroupCount++] = universe;
+  Debug::info("E131", "Joined multicast 239.255.%u.%u", (universe >> 8) & 0xFF, universe & 0xFF);
+}
 
-  const uint8_t *dmp = &data[115];
-  uint8_t dmpVector = dmp[0];
-  if (dmpVector != 0x02) return false;
-  uint8_t addrType = dmp[1];
-  if (addrType != 0xa1) return false;
+static void updateGroups() {
+  if (!sConn || !sMulticast) return;
 
-  uint16_t propValCount = (dmp[3] << 8) | dmp[4];
-  if (propValCount < 2) return false;
+  for (uint8_t i = 0; i < sGroupCount;) {
+    if (wantsGroup(sGroups[i])) {
+      ++i;
+      continue;
+    }
+    setMembership(sGroups[i], false);
+    Debug::info("E131", "Left multicast universe %u", sGroups[i]);
+    sGroups[i] = sGroups[--sGroupCount];
+  }
 
-  size_t pixelLen = propValCount - 1; // first is DMX start code
-  if (pixelLen > sPixelBuffer.size()) {
-    // auto-grow to support config
-    sPixelBuffer.resize(pixelLen);
+  for (uint16_t i = 0; i < sUniverseCount; ++i) {
+    ensureGroup(sSlots[i].universe);
+  }
+  if (sSyncAddress != 0 && sSyncAddress <= kMaxE131Universe) {
+    ensureGroup(sSyncAddress);
   }
-  size_t dmxLen = std::min<size_t>(pixelLen, sDMXBuffer.size());
+}
 
-  info.length = pixelLen;
-  info.timestampMs = millis();
+static void followSync(const PacketInfo &info) {
+  uint16_t previous = sSyncAddress;
+  if (sSyncEnabled && info.syncAddress != 0) {
+    if (sSyncAddress != info.syncAddress) {
+      sSyncAddress = info.syncAddress;
+      sSyncLocked = false; // wait for the first sync packet before holding
+    }
+  } else {
+    sSyncAddress = 0;
+    sSyncLocked = false;
+  }
+  if (sSyncAddress != previous) {
+    updateGroups();
+  }
+}
+
+static bool storeUniverse(uint16_t slotIndex, const uint8_t *payload, const PacketInfo &info) {
+  if (info.options & E131Packet::kOptionStreamTerminated) {
+    E131Merge::remove(slotIndex, info.cid.data());
+    return false;
+  }
 
-  memcpy(sPixelBuffer.data(), &dmp[5], std::min<size_t>(pixelLen, sPixelBuffer.size()));
-  memcpy(sDMXBuffer.data(), &dmp[5], dmxLen);
+  E131Merge::Sequencing sequencing = E131Merge::Sequencing::E131;
+  if (info.artnet) {
+    sequencing = info.sequence == 0 ? E131Merge::Sequencing::None : E131Merge::Sequencing::ArtNet;
+  }
+  E131Merge::Claim claim = E131Merge::claim(slotIndex, info.cid.data(), info.priority,
+                                             info.sequence, info.timestampMs, sequencing);
+  portENTER_CRITICAL(&sStatsMux);
+  sPacketStats.lost += claim.lost;
+  switch (claim.verdict) {
+    case E131Merge::Verdict::Accepted:  sPacketStats.accepted++; break;
+    case E131Merge::Verdict::Stale:     sPacketStats.stale++; break;
+    case E131Merge::Verdict::Duplicate: sPacketStats.duplicate++; break;
+    case E131Merge::Verdict::Outranked: sPacketStats.outranked++; break;
+  }
+  portEXIT_CRITICAL(&sStatsMux);
+  if (claim.verdict != E131Merge::Verdict::Accepted) {
+    return false;
+  }
+
+  followSync(info);
+  bool synced = sSyncAddress != 0 && syncHeld(info.timestampMs);
 
+  uint32_t bit = 1UL << slotIndex;
+  if (!synced && (sReceivedMask & bit)) {
+    // A universe repeated before the frame completed: the source is not
+    // sending every configured universe, so close out what we have.
+    publishFrame();
+  }
+
+  UniverseSlot &slot = sSlots[slotIndex];
+  uint8_t *target = sFrames[sWriteIndex].slots.data() + slot.offset;
+  const uint8_t *current = target;
+  if (!(sReceivedMask & bit) && sPublishedIndex >= 0) {
+    current = sFrames[sPublishedIndex].slots.data() + slot.offset;
+  }
+  slot.length = E131Merge::merge(slotIndex, claim.source, payload, info.length,
+                                 current, slot.length, target);
+  slot.packets++;
+  sLastSlot = slotIndex;
+
+  sReceivedMask |= bit;
+  if (!synced && (sReceivedMask & sCompleteMask) == sCompleteMask) {
+    publishFrame();
+  }
   return true;
 }
 
+static void handleSync(const PacketInfo &info) {
+  if (!sSyncEnabled || sSyncAddress == 0 || info.syncAddress != sSyncAddress) return;
+  if (!sSyncLocked) {
+    Debug::info("E131", "Locked to sync universe %u", sSyncAddress);
+    sSyncLocked = true;
+  }
+  sLastSyncMs = info.timestampMs;
+  sSyncPackets++;
+  if (sReceivedMask != 0) {
+    publishFrame();
+  }
+}
+
 static void connectWiFi(const Prizm::PrizmConfig &cfg) {
   WiFi.mode(WIFI_STA);
   WiFi.setHostname(cfg.network.hostname.c_str());
@@ -83,112 +418,492 @@ static void connectWiFi(const Prizm::PrizmConfig &cfg) {
     delay(200);
   }
 
+  IPAddress ip;
   if (WiFi.status() == WL_CONNECTED) {
     sWiFiConnected = true;
-    Debug::info("WiFi", "Connected, IP=%s", WiFi.localIP().toString().c_str());
+    ip = WiFi.localIP();
+    Debug::info("WiFi", "Connected, IP=%s", ip.toString().c_str());
   } else if (cfg.network.apFallback) {
     Debug::warn("WiFi", "Station connect failed, starting AP");
     WiFi.mode(WIFI_AP);
     WiFi.softAP(cfg.network.hostname.c_str(), cfg.network.password.c_str());
     sWiFiConnected = true;
+    ip = WiFi.softAPIP();
   } else {
     Debug::error("WiFi", "Failed to connect");
   }
+
+  for (int i = 0; i < 4; ++i) sLocalIp[i] = ip[i];
+  WiFi.macAddress(sLocalMac);
+  sHostname = cfg.network.hostname;
 }
 
-bool begin(const Prizm::PrizmConfig &cfg) {
-  sUniverseBase = cfg.e131.startUniverse;
-  sUniverseCount = cfg.e131.universeCount;
-  sPixelBuffer.assign(cfg.pixels.count * (cfg.pixels.useWhiteChannel ? 4 : 3), 0);
-  sDMXBuffer.assign(cfg.dmx.channels, 0);
+static void noteAccepted(const PacketInfo &info) {
+  portENTER_CRITICAL(&sStatsMux);
+  sLastPacketInfo = info;
+  portEXIT_CRITICAL(&sStatsMux);
+  sLastPacketMs = info.timestampMs;
+  sActive = true;
 
-  connectWiFi(cfg);
+  uint32_t now = millis();
+  if (now - sLastFpsUpdateMs >= 1000) {
+    sFps = (1000.0f * sFrameCounter) / (now - sLastFpsUpdateMs);
+    sFrameCounter = 0;
+    sLastFpsUpdateMs = now;
+  }
+}
 
-  if (!sWiFiConnected) return false;
-
-  bool bound = false;
-  if (cfg.network.multicast) {
-    IPAddress group(239,
-                    255,
-                    (cfg.e131.startUniverse >> 8) & 0xFF,
-                    cfg.e131.startUniverse & 0xFF);
-    bound = sUdp.beginMulticast(WiFi.localIP(), group, kE131Port);
-    if (bound) {
-      Debug::info("E131", "Joined multicast %s", group.toString().c_str());
-    } else {
-      Debug::warn("E131", "Multicast bind failed, falling back to unicast");
-    }
+static void processPacket(const uint8_t *data, size_t len, const ip_addr_t *) {
+  E131Packet::View packet = E131Packet::parse(data, len);
+  if (packet.kind == E131Packet::Kind::Invalid) {
+    return;
   }
-  if (!bound) {
-    bound = sUdp.begin(kE131Port);
+
+  PacketInfo info;
+  memcpy(info.cid.data(), packet.cid, info.cid.size());
+  info.syncAddress = packet.syncAddress;
+  info.timestampMs = millis();
+  if (packet.kind == E131Packet::Kind::Sync) {
+    handleSync(info);
+    return;
   }
-  if (!bound) {
-    Debug::error("E131", "UDP bind failed");
-    return false;
+
+  info.universe = packet.universe;
+  info.sequence = packet.sequence;
+  info.priority = packet.priority;
+  info.options = packet.options;
+  info.length = packet.length;
+
+  if (info.universe < sUniverseBase || info.universe >= sUniverseBase + sUniverseCount) {
+    return; // not in configured range
   }
 
-  Debug::info("E131", "Listening on port %d", kE131Port);
-  sLastPacketMs = millis();
-  sLastFpsUpdateMs = sLastPacketMs;
+  if (!storeUniverse(info.universe - sUniverseBase, packet.levels, info)) {
+    return;
+  }
+  noteAccepted(info);
+}
 
-  return true;
+static void sendPollReplies(const ip_addr_t *to) {
+  ArtNet::PollReplyInfo reply;
+  memcpy(reply.ip, sLocalIp, sizeof(reply.ip));
+  memcpy(reply.mac, sLocalMac, sizeof(reply.mac));
+  reply.shortName = sHostname.c_str();
+  reply.longName = "PrizmLink E1.31/Art-Net receiver";
+
+  // One reply per run of up to four ports that share Net and SubNet.
+  uint8_t bindIndex = 1;
+  for (uint16_t i = 0; i < sUniverseCount;) {
+    reply.portAddress = sArtNetBase + i;
+    uint8_t ports = 0;
+    while (ports < 4 && i + ports < sUniverseCount &&
+           ((reply.portAddress + ports) & 0x7FF0) == (reply.portAddress & 0x7FF0)) {
+      ports++;
+    }
+    reply.ports = ports;
+    reply.bindIndex = bindIndex++;
+
+    struct netbuf *buf = netbuf_new();
+    if (!buf) return;
+    void *payload = netbuf_alloc(buf, ArtNet::kPollReplyLength);
+    if (payload && ArtNet::buildPollReply(reply, static_cast<uint8_t*>(payload),
+                                          ArtNet::kPollReplyLength)) {
+      netconn_sendto(sArtConn, buf, to, ArtNet::kPort);
+    }
+    netbuf_delete(buf);
+    i += ports;
+  }
 }
 
-void loop() {
-  if (!sWiFiConnected) return;
+static void handleArtSync() {
+  sArtSyncSeen = true;
+  sLastArtSyncMs = millis();
+  PacketInfo info;
+  info.artnet = true;
+  info.syncAddress = kArtSyncAddress;
+  info.timestampMs = sLastArtSyncMs;
+  handleSync(info);
+}
+
+static void processArtNet(const uint8_t *data, size_t len, const ip_addr_t *from) {
+  ArtNet::OpCode opcode;
+  if (!ArtNet::parseHeader(data, len, opcode)) return;
+
+  switch (opcode) {
+    case ArtNet::OpCode::Poll:
+      if (from) sendPollReplies(from);
+      return;
+    case ArtNet::OpCode::Sync:
+      handleArtSync();
+      return;
+    case ArtNet::OpCode::Dmx:
+      break;
+    default:
+      return;
+  }
+
+  ArtNet::DmxPacket dmx;
+  if (!ArtNet::parseDmx(data, len, dmx)) return;
+  if (dmx.portAddress < sArtNetBase || dmx.portAddress >= sArtNetBase + sUniverseCount) {
+    return; // not in configured range
+  }
 
-  int packetSize = sUdp.parsePacket();
-  if (packetSize <= 0) {
-    sActive = (millis() - sLastPacketMs) < Prizm::Config::active.failsafe.timeoutMs;
+  PacketInfo info;
+  info.artnet = true;
+  info.universe = sUniverseBase + (dmx.portAddress - sArtNetBase);
+  info.sequence = dmx.sequence;
+  info.length = dmx.length;
+  info.priority = kArtNetPriority;
+  info.timestampMs = millis();
+  if (sArtSyncSeen && info.timestampMs - sLastArtSyncMs < sSyncTimeoutMs) {
+    info.syncAddress = kArtSyncAddress;
+  }
+  // Art-Net has no CID; the sender's IPv4 address identifies the source.
+  if (from) {
+    uint32_t addr = ip_2_ip4(from)->addr;
+    memcpy(info.cid.data(), &addr, sizeof(addr));
+  }
+  info.cid[15] = 0xA7;
+
+  portENTER_CRITICAL(&sStatsMux);
+  sPacketStats.artnet++;
+  portEXIT_CRITICAL(&sStatsMux);
+
+  if (!storeUniverse(info.universe - sUniverseBase, dmx.data, info)) {
     return;
   }
+  noteAccepted(info);
+}
+
+static void processDdp(const uint8_t *data, size_t len, const ip_addr_t *) {
+  DDP::Packet packet;
+  if (!DDP::parse(data, len, packet)) return;
+  if (packet.destination != DDP::kDefaultOutput && packet.destination != DDP::kAllDevices) return;
+
+  Frame &frame = sFrames[sWriteIndex];
+  if (packet.length > 0) {
+    if (packet.offset >= sSlotBytes) return; // beyond the configured universes
+    size_t length = std::min<size_t>(packet.length, sSlotBytes - packet.offset);
+    memcpy(frame.slots.data() + packet.offset, packet.data, length);
+
+    size_t end = packet.offset + length;
+    addDdpSpan(packet.offset, end);
+    sDdpLength = std::max(sDdpLength, end);
+  }
+
+  portENTER_CRITICAL(&sStatsMux);
+  sPacketStats.ddp++;
+  portEXIT_CRITICAL(&sStatsMux);
+
+  sDdpPushSeen |= packet.push;
+  if (packet.push || !sDdpPushSeen) {
+    publishFrame();
+  }
+
+  PacketInfo info;
+  info.sequence = packet.sequence;
+  info.length = packet.length;
+  info.timestampMs = millis();
+  noteAccepted(info);
+}
 
-  static std::vector<uint8_t> buffer(1500);
-  if (packetSize > static_cast<int>(buffer.size())) {
-    buffer.resize(packetSize);
+static void sendBridge(const uint8_t *levels, uint16_t length) {
+  if (!sBridgeConn) return;
+  E131Packet::Source source;
+  source.cid = sLocalCid.data();
+  source.name = sHostname.c_str();
+  source.priority = sLocalCfg.priority;
+
+  struct netbuf *buf = netbuf_new();
+  if (!buf) return;
+  void *payload = netbuf_alloc(buf, E131Packet::kDataHeaderLength + length);
+  if (payload && E131Packet::buildData(static_cast<uint8_t*>(payload), E131Packet::kDataHeaderLength + length,
+                                       source, sLocalCfg.universe, sLocalSequence, levels, length)) {
+    ip_addr_t group;
+    IP_ADDR4(&group, 239, 255, (sLocalCfg.universe >> 8) & 0xFF, sLocalCfg.universe & 0xFF);
+    netconn_sendto(sBridgeConn, buf, &group, E131Packet::kPort);
   }
+  netbuf_delete(buf);
+}
+
+static void processLocal() {
+  if (!sLocalPending.exchange(false)) return;
+  std::array<uint8_t, 512> levels;
+  portENTER_CRITICAL(&sStatsMux);
+  uint16_t length = sLocalLength;
+  memcpy(levels.data(), sLocalLevels.data(), length);
+  sPacketStats.local++;
+  portEXIT_CRITICAL(&sStatsMux);
 
-  int len = sUdp.read(buffer.data(), buffer.size());
-  if (len <= 0) return;
+  sLocalSequence++;
+  if (sLocalCfg.bridge) sendBridge(levels.data(), length);
 
+  uint16_t universe = sLocalCfg.universe;
+  if (!sLocalCfg.merge || universe < sUniverseBase || universe >= sUniverseBase + sUniverseCount) {
+    return;
+  }
   PacketInfo info;
-  if (!isValidE131(buffer.data(), len, info)) {
+  info.universe = universe;
+  info.length = length;
+  info.sequence = sLocalSequence;
+  info.priority = sLocalCfg.priority;
+  info.timestampMs = millis();
+  info.cid = sLocalCid;
+  if (!storeUniverse(universe - sUniverseBase, levels.data(), info)) {
     return;
   }
+  noteAccepted(info);
+}
 
-  if (info.universe < sUniverseBase || info.universe >= sUniverseBase + sUniverseCount) {
-    return; // not in configured range
+static void applyPendingConfig() {
+  if (!sReconfigurePending.exchange(false)) return;
+
+  portENTER_CRITICAL(&sStatsMux);
+  Prizm::E131Config cfg = sPendingConfig;
+  portEXIT_CRITICAL(&sStatsMux);
+
+  buildSlotTable(cfg);
+  // Only the write frame belongs to this task; the middle and read frames
+  // keep their old layout until they are replaced.
+  Frame &frame = sFrames[sWriteIndex];
+  std::fill(frame.slots.begin(), frame.slots.end(), 0);
+  frame.lengths.fill(0);
+  sPublishedIndex = -1;
+  E131Merge::begin(cfg, sUniverseCount, sChannelsPerUniverse);
+  updateGroups();
+  Debug::info("E131", "Universes %u-%u", sUniverseBase, sUniverseBase + sUniverseCount - 1);
+}
+
+typedef void (*DatagramHandler)(const uint8_t *data, size_t len, const ip_addr_t *from);
+
+// Drains every datagram already queued on `conn` without blocking. Payloads
+// are parsed in place unless lwIP handed over a chained pbuf.
+static uint16_t drainConn(struct netconn *conn, DatagramHandler handler) {
+  uint16_t drained = 0;
+  struct netbuf *buf = nullptr;
+  while (netconn_recv(conn, &buf) == ERR_OK) {
+    drained++;
+    void *data = nullptr;
+    u16_t len = 0;
+    netbuf_data(buf, &data, &len);
+    if (len == netbuf_len(buf)) {
+      handler(static_cast<const uint8_t*>(data), len, netbuf_fromaddr(buf));
+    } else {
+      u16_t copied = netbuf_copy(buf, sScratch.data(), sScratch.size());
+      handler(sScratch.data(), copied, netbuf_fromaddr(buf));
+    }
+    netbuf_delete(buf);
   }
+  return drained;
+}
 
-  sLastPacketInfo = info;
-  sLastPacketMs = info.timestampMs;
-  sPacketCounter++;
-  sActive = true;
+// One receive pass over every open socket plus timeout housekeeping. Returns how
+// many datagrams were handled so the caller can track queue depth.
+static uint16_t pollSockets() {
+  applyPendingConfig();
+
+  processLocal();
+
+  uint16_t drained = 0;
+  if (sConn) drained += drainConn(sConn, processPacket);
+  if (sArtConn) drained += drainConn(sArtConn, processArtNet);
+  if (sDdpConn) drained += drainConn(sDdpConn, processDdp);
 
   uint32_t now = millis();
-  if (now - sLastFpsUpdateMs >= 1000) {
-    sFps = (1000.0f * sPacketCounter) / (now - sLastFpsUpdateMs);
-    sPacketCounter = 0;
-    sLastFpsUpdateMs = now;
+  sActive = (now - sLastPacketMs) < sFailsafeTimeoutMs;
+  syncHeld(now);
+
+  if (drained > 0) {
+    portENTER_CRITICAL(&sStatsMux);
+    sPacketStats.queueDepth = drained;
+    sPacketStats.queuePeak = std::max(sPacketStats.queuePeak, drained);
+    portEXIT_CRITICAL(&sStatsMux);
+  }
+  return drained;
+}
+
+// Runs in the lwIP thread whenever a datagram is queued on any socket.
+static void socketEvent(struct netconn *, enum netconn_evt evt, u16_t) {
+  if (evt == NETCONN_EVT_RCVPLUS && sRxTask) {
+    xTaskNotifyGive(sRxTask);
+  }
+}
+
+static void receiveTask(void *) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(kRxWaitMs));
+    pollSockets();
+  }
+}
+
+static struct netconn *openSocket(uint16_t port) {
+  struct netconn *conn = netconn_new_with_callback(NETCONN_UDP, socketEvent);
+  if (!conn) return nullptr;
+  if (netconn_bind(conn, IP_ADDR_ANY, port) != ERR_OK) {
+    netconn_delete(conn);
+    return nullptr;
+  }
+  netconn_set_nonblocking(conn, 1);
+  Debug::info("E131", "Listening on port %u", port);
+  return conn;
+}
+
+bool begin(const Prizm::PrizmConfig &cfg) {
+  buildSlotTable(cfg.e131);
+  sFailsafeTimeoutMs = cfg.failsafe.timeoutMs;
+  for (Frame &frame : sFrames) {
+    frame.slots.assign(static_cast<size_t>(Prizm::kMaxUniverses) * 512, 0);
+    frame.layout = sLayout;
+    frame.pixelLength = 0;
+    frame.dmxOffset = 0;
+    frame.dmxLength = 0;
+    frame.lengths.fill(0);
+  }
+  sPublishedIndex = -1;
+  E131Merge::begin(cfg.e131, sUniverseCount, sChannelsPerUniverse);
+
+  connectWiFi(cfg);
+  sLocalCfg = cfg.dmxIn;
+  memcpy(sLocalCid.data() + 10, sLocalMac, sizeof(sLocalMac));
+  bool local = cfg.dmxIn.enabled && (cfg.dmxIn.merge || cfg.dmxIn.bridge);
+
+  if (sWiFiConnected) {
+    if (cfg.e131.protocol != Prizm::InputProtocol::ArtNet) {
+      sConn = openSocket(E131Packet::kPort);
+      if (!sConn) Debug::error("E131", "UDP bind failed on %u", E131Packet::kPort);
+      sMulticast = cfg.network.multicast;
+      sGroupCount = 0;
+      updateGroups();
+    }
+    if (cfg.e131.protocol != Prizm::InputProtocol::E131) {
+      sArtConn = openSocket(ArtNet::kPort);
+      if (!sArtConn) Debug::error("E131", "UDP bind failed on %u", ArtNet::kPort);
+    }
+    if (cfg.e131.ddp) {
+      sDdpConn = openSocket(DDP::kPort);
+      if (!sDdpConn) Debug::error("E131", "UDP bind failed on %u", DDP::kPort);
+    }
+    if (local && cfg.dmxIn.bridge && !sBridgeConn) {
+      sBridgeConn = netconn_new(NETCONN_UDP);
+      if (sBridgeConn && netconn_bind(sBridgeConn, IP_ADDR_ANY, 0) != ERR_OK) {
+        netconn_delete(sBridgeConn);
+        sBridgeConn = nullptr;
+      }
+      if (!sBridgeConn) Debug::error("E131", "DMX bridge socket failed");
+    }
   }
+  // A wired DMX source keeps the receive task useful without a network.
+  if (!sConn && !sArtConn && !sDdpConn && !local) return false;
+
+  sLastPacketMs = millis();
+  sLastFpsUpdateMs = sLastPacketMs;
+
+  if (!sRxTask &&
+      xTaskCreatePinnedToCore(receiveTask, "e131Rx", kRxTaskStack, nullptr, kRxTaskPriority,
+                              &sRxTask, kRxTaskCore) != pdPASS) {
+    sRxTask = nullptr;
+    Debug::warn("E131", "Receive task failed to start, polling from loop()");
+  }
+
+  return true;
+}
+
+void loop() {
+  if (sRxTask || (!sConn && !sArtConn && !sDdpConn && !sLocalCfg.enabled)) return;
+  pollSockets();
+}
+
+void submitLocal(const uint8_t *levels, size_t length) {
+  length = std::min(length, sLocalLevels.size());
+  portENTER_CRITICAL(&sStatsMux);
+  memcpy(sLocalLevels.data(), levels, length);
+  sLocalLength = length;
+  portEXIT_CRITICAL(&sStatsMux);
+  sLocalPending = true;
+  if (sRxTask) xTaskNotifyGive(sRxTask);
 }
 
 bool hasData() {
   return sActive && !sManualOverride;
 }
 
+bool takeFrame() {
+  if (!(sMiddleIndex.load(std::memory_order_acquire) & kFreshFrame)) return false;
+  uint8_t previous = sMiddleIndex.exchange(sReadIndex, std::memory_order_acq_rel);
+  sReadIndex = previous & kFrameIndexMask;
+  return true;
+}
+
+uint32_t receivedMask() {
+  return sReceivedMask;
+}
+
+void reconfigure(const Prizm::E131Config &cfg) {
+  portENTER_CRITICAL(&sStatsMux);
+  sPendingConfig = cfg;
+  portEXIT_CRITICAL(&sStatsMux);
+  sReconfigurePending = true;
+}
+
+uint32_t universePackets(uint16_t universe) {
+  if (universe >= sUniverseBase && universe < sUniverseBase + sUniverseCount) {
+    return sSlots[universe - sUniverseBase].packets;
+  }
+  return universe != 0 && universe == sSyncAddress ? sSyncPackets : 0;
+}
+
+uint8_t multicastGroupCount() {
+  return sGroupCount;
+}
+
+bool syncActive() {
+  return sSyncLocked;
+}
+
+uint16_t syncAddress() {
+  return sSyncAddress;
+}
+
 const uint8_t *pixelData(size_t &length) {
-  length = sLastPacketInfo.length;
-  return sPixelBuffer.data();
+  const Frame &frame = sFrames[sReadIndex];
+  length = frame.pixelLength;
+  return frame.slots.data();
 }
 
 const uint8_t *dmxData(size_t &length) {
-  length = std::min<size_t>(sLastPacketInfo.length, sDMXBuffer.size());
-  return sDMXBuffer.data();
+  const Frame &frame = sFrames[sReadIndex];
+  length = frame.dmxLength;
+  return frame.slots.data() + frame.dmxOffset;
+}
+
+const uint8_t *universeData(uint16_t universe, size_t &length) {
+  length = 0;
+  const Frame &frame = sFrames[sReadIndex];
+  const FrameLayout &layout = frame.layout;
+  if (universe < layout.startUniverse || universe >= layout.startUniverse + layout.universeCount) {
+    return nullptr;
+  }
+  uint16_t index = universe - layout.startUniverse;
+  length = frame.lengths[index];
+  return frame.slots.data() + static_cast<size_t>(index) * layout.channelsPerUniverse;
+}
+
+FrameLayout frameLayout() {
+  return sFrames[sReadIndex].layout;
 }
 
 PacketInfo lastPacket() {
-  return sLastPacketInfo;
+  portENTER_CRITICAL(&sStatsMux);
+  PacketInfo info = sLastPacketInfo;
+  portEXIT_CRITICAL(&sStatsMux);
+  return info;
+}
+
+PacketStats packetStats() {
+  portENTER_CRITICAL(&sStatsMux);
+  PacketStats stats = sPacketStats;
+  portEXIT_CRITICAL(&sStatsMux);
+  return stats;
 }
 
 float fps() {
@@ -2,7 +2,6 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
-#include <WiFiUdp.h>
 #include <vector>
 #include "config.h"
 
@@ -13,16 +12,83 @@ struct PacketInfo {
   size_t length {0};
   uint32_t sequence {0};
   uint32_t timestampMs {0};
+  uint16_t syncAddress {0};
+  uint8_t options {0};
+  uint8_t priority {0};
+  std::array<uint8_t, 16> cid {};  // Art-Net: sender IPv4 address
+  bool artnet {false};
 };
 
+// Running totals since boot, per accepted-universe packet.
+struct PacketStats {
+  uint32_t accepted {0};
+  uint32_t stale {0};      // discarded by the E1.31 out-of-order rule
+  uint32_t duplicate {0};
+  uint32_t lost {0};       // sequence gaps
+  uint32_t outranked {0};  // lost source arbitration
+  uint32_t artnet {0};     // ArtDmx packets in the configured range
+  uint32_t ddp {0};        // DDP data packets
+  uint32_t local {0};      // frames from the local DMX input
+  uint32_t overruns {0};   // frames replaced before the output side took them
+  uint16_t queueDepth {0}; // datagrams drained in the last receive pass
+  uint16_t queuePeak {0};
+};
+
+// Connects Wi-Fi, binds the E1.31 and/or Art-Net sockets selected by
+// E131Config::protocol (plus DDP when enabled) and starts the receive task
+// on core 0. loop() only polls the socket itself if the task failed to start.
 bool begin(const Prizm::PrizmConfig &cfg);
 void loop();
 
+// Hands over a frame from the local DMX input (any task). Per
+// PrizmConfig::dmxIn it is merged as a source on its universe and/or
+// re-sent as E1.31 multicast by the receive task.
+void submitLocal(const uint8_t *levels, size_t length);
+
 bool hasData();
+
+// Returns true when a newer assembled frame (all configured universes
+// received, a universe repeated early, or a sync packet) has been handed
+// over; pixelData()/dmxData() then point at it until the next call.
+bool takeFrame();
+uint32_t receivedMask();
+
+// Swaps in a new universe range. The slot table, merge state and multicast
+// memberships are rebuilt by the receive task before its next socket pass;
+// groups for universes that left the range are dropped. Frames already
+// handed over keep their old layout, see frameLayout().
+void reconfigure(const Prizm::E131Config &cfg);
+
+// How the slots of a frame are arranged. `generation` changes each time a
+// reconfigure() takes effect, so consumers know when to rebuild offsets.
+struct FrameLayout {
+  uint16_t startUniverse {0};
+  uint16_t universeCount {0};
+  uint16_t channelsPerUniverse {0};
+  uint32_t generation {0};
+};
+
+// Layout of the frame pixelData()/dmxData() currently point at.
+FrameLayout frameLayout();
+
+// Accepted packets per configured universe (one multicast group each); for
+// the followed sync universe this counts sync packets.
+uint32_t universePackets(uint16_t universe);
+uint8_t multicastGroupCount();
+
+// True while the source is tagging data with a sync universe and frames are
+// latched by E1.31 sync packets rather than on universe completion.
+bool syncActive();
+uint16_t syncAddress();
+
 const uint8_t *pixelData(size_t &length);
 const uint8_t *dmxData(size_t &length);
+// Levels of one configured universe in the current frame; nullptr if the
+// universe is outside the configured range.
+const uint8_t *universeData(uint16_t universe, size_t &length);
 
 PacketInfo lastPacket();
+PacketStats packetStats();
 
 float fps();
 
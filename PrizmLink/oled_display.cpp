@@ -42,8 +42,10 @@ void update(const Prizm::RuntimeStats &stats, const Prizm::PrizmConfig &cfg) {
 
   drawLine("IP", WiFi.localIP().toString(), 0);
   drawLine("FPS", String(stats.fps, 1), 1);
-  drawLine("DMX", String(cfg.dmx.channels), 2);
-  drawLine("Px", String(cfg.pixels.count), 3);
+  String dmx = String(cfg.dmx.ports[0].channels);
+  if (cfg.dmx.portCount > 1) dmx += " x" + String(cfg.dmx.portCount);
+  drawLine("DMX", dmx, 2);
+  drawLine("Px", String(Prizm::totalPixels(cfg.pixels)), 3);
   sDisplay.display();
 }
 
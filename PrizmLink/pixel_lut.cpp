@@ -0,0 +1,42 @@
+#include <cmath>
+#include "pixel_lut.h"
+
+namespace PixelLUT {
+
+static_assert(kLinear[255] == 65535 && kLinear[128] == 32896, "linear curve");
+static_assert(kGamma22[0] == 0 && kGamma22[255] == 65535, "gamma curve endpoints");
+
+const GammaTable &gammaTable(float gamma, GammaTable &custom) {
+  if (std::fabs(gamma - 1.0f) < 0.01f) return kLinear;
+  if (std::fabs(gamma - 2.2f) < 0.01f) return kGamma22;
+  if (std::fabs(gamma - 2.8f) < 0.01f) return kGamma28;
+
+  custom[0] = 0;
+  for (size_t i = 1; i < custom.size(); ++i) {
+    custom[i] = static_cast<uint16_t>(std::pow(i / 255.0f, gamma) * 65535.0f + 0.5f);
+  }
+  return custom;
+}
+
+static uint32_t scaleFor(uint8_t balance, uint8_t brightness) {
+  // balance × brightness as a 16-bit fraction of full scale
+  return (static_cast<uint32_t>(balance) * brightness * 65535U + 32512U) / 65025U;
+}
+
+void buildWide(WideTable &out, const GammaTable &gamma, uint8_t balance, uint8_t brightness) {
+  uint32_t scale = scaleFor(balance, brightness);
+  for (size_t i = 0; i < gamma.size(); ++i) {
+    out[i] = static_cast<uint16_t>((static_cast<uint64_t>(gamma[i]) * scale + 32767U) / 65535U);
+  }
+  out[256] = out[255];
+}
+
+void build(ChannelTable &out, const GammaTable &gamma, uint8_t balance, uint8_t brightness) {
+  uint32_t scale = scaleFor(balance, brightness);
+  for (size_t i = 0; i < out.size(); ++i) {
+    uint64_t level = (static_cast<uint64_t>(gamma[i]) * scale + 32767U) / 65535U;
+    out[i] = static_cast<uint8_t>((level * 255U + 32767U) / 65535U);
+  }
+}
+
+} // namespace PixelLUT
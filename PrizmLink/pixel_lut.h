@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Per-channel lookup tables folding gamma, white balance and master
+// brightness into one byte → byte step. Gamma curves are kept at 16-bit
+// precision so scaling them down for brightness does not flatten the low end.
+namespace PixelLUT {
+
+using GammaTable = std::array<uint16_t, 256>;
+using ChannelTable = std::array<uint8_t, 256>;
+using WideTable = std::array<uint16_t, 257>;  // last entry repeats [255] for interpolation
+
+namespace detail {
+
+// C++17 has no constexpr pow; these are just accurate enough to generate
+// 16-bit gamma tables at compile time.
+constexpr double ln(double x) {
+  int exponent = 0;
+  while (x < 0.5) { x *= 2.0; --exponent; }
+  while (x >= 1.0) { x *= 0.5; ++exponent; }
+  double y = (x - 1.0) / (x + 1.0);  // ln(x) = 2 atanh(y), |y| <= 1/3
+  double y2 = y * y;
+  double term = y;
+  double sum = 0.0;
+  for (int n = 1; n < 40; n += 2) {
+    sum += term / n;
+    term *= y2;
+  }
+  return 2.0 * sum + exponent * 0.69314718055994530942;
+}
+
+constexpr double exp(double x) {
+  int halvings = 0;
+  while (x < -0.5) { x *= 0.5; ++halvings; }
+  double term = 1.0;
+  double sum = 1.0;
+  for (int n = 1; n < 20; ++n) {
+    term *= x / n;
+    sum += term;
+  }
+  while (halvings-- > 0) sum *= sum;
+  return sum;
+}
+
+} // namespace detail
+
+constexpr GammaTable makeGamma(double gamma) {
+  GammaTable table {};
+  for (size_t i = 1; i < table.size(); ++i) {
+    double level = detail::exp(gamma * detail::ln(i / 255.0));
+    table[i] = static_cast<uint16_t>(level * 65535.0 + 0.5);
+  }
+  return table;
+}
+
+constexpr GammaTable kLinear = makeGamma(1.0);
+constexpr GammaTable kGamma22 = makeGamma(2.2);
+constexpr GammaTable kGamma28 = makeGamma(2.8);
+
+// Returns one of the built-in curves when `gamma` matches, otherwise fills
+// `custom` at runtime and returns it.
+const GammaTable &gammaTable(float gamma, GammaTable &custom);
+
+// out[v] = gamma[v] × balance/255 × brightness/255, rounded to 8 bits.
+void build(ChannelTable &out, const GammaTable &gamma, uint8_t balance, uint8_t brightness);
+
+// Same scaling kept at 16 bits for the dithered pipeline.
+void buildWide(WideTable &out, const GammaTable &gamma, uint8_t balance, uint8_t brightness);
+
+// Looks up a 16-bit input level, interpolating between the coarse entries.
+inline uint16_t lookupWide(const WideTable &table, uint16_t level) {
+  uint8_t coarse = level >> 8;
+  int32_t lo = table[coarse];
+  int32_t hi = table[coarse + 1];
+  return static_cast<uint16_t>(lo + (((hi - lo) * (level & 0xFF)) >> 8));
+}
+
+} // namespace PixelLUT
@@ -1,99 +1,750 @@
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include "pixel_output.h"
 #include "debug_utils.h"
 #include "failsafe_fx.h"
+#include "pixel_lut.h"
+#include "pixel_power.h"
+#include "pixel_simd.h"
 
 namespace PixelOutput {
 
 static bool sReady = false;
 static uint16_t sPixelCount = 0;
-static CRGB *sLeds = nullptr;
+static size_t sWireUnits = 0;            // CRGB-sized units across all wire buffers
+static CRGB *sLeds = nullptr;            // render buffer, written from loop(), never scaled
+static CRGB *sRender = nullptr;          // logical RGB pixels for FailsafeFX
 static uint8_t sBaseBrightness = 255;
-static bool sHasWhite = false;
 
-bool begin(const Prizm::PixelConfig &cfg) {
+// The pixel buffers hold bytes in wire order. FastLED is handed each strip as
+// RGB-ordered CRGB units at full scale, so it clocks the bytes out untouched;
+// an RGBW strip is simply 4/3 as many units. Channel order, the white channel
+// and whether the strip is mapped are resolved once per strip when picking a
+// kernel, and gamma, white balance and brightness are a single table lookup
+// per byte.
+//
+// Mapped strips carry a table of physical LED indices in source order, `group`
+// entries per source pixel; unmapped strips are written sequentially.
+// Kernels return the sum of the 8-bit levels they lit, for power estimation.
+typedef uint32_t (*CopyKernel)(uint8_t *dst, const uint8_t *src, size_t pixels, const uint8_t *order,
+                           const PixelLUT::ChannelTable *lut, const uint16_t *map, uint8_t group);
+
+template <uint8_t Channels, bool Mapped>
+static uint32_t copy8(uint8_t *dst, const uint8_t *src, size_t pixels, const uint8_t *order,
+                  const PixelLUT::ChannelTable *lut, const uint16_t *map, uint8_t group) {
+  const uint8_t o0 = order[0], o1 = order[1], o2 = order[2];
+  const uint8_t *l0 = lut[0].data(), *l1 = lut[1].data(), *l2 = lut[2].data(), *l3 = lut[3].data();
+  uint32_t sum = 0;
+  for (size_t i = 0; i < pixels; ++i, src += Channels) {
+    uint8_t px[Channels];
+    px[0] = l0[src[o0]];
+    px[1] = l1[src[o1]];
+    px[2] = l2[src[o2]];
+    sum += px[0] + px[1] + px[2];
+    if constexpr (Channels == 4) {
+      px[3] = l3[src[3]];
+      sum += px[3];
+    }
+
+    if constexpr (Mapped) {
+      for (uint8_t g = 0; g < group; ++g) {
+        memcpy(dst + *map++ * Channels, px, Channels);
+      }
+    } else {
+      memcpy(dst, px, Channels);
+      dst += Channels;
+    }
+  }
+  return Mapped ? sum * group : sum;
+}
+
+// Tables that come out as identity (linear gamma, neutral balance, full
+// brightness) are skipped: the strip only needs its bytes reordered.
+template <uint8_t Channels, bool Mapped>
+static uint32_t pass8(uint8_t *dst, const uint8_t *src, size_t pixels, const uint8_t *order,
+                      const PixelLUT::ChannelTable *, const uint16_t *map, uint8_t group) {
+  if constexpr (!Mapped && Channels == 3) {
+    return PixelSIMD::shuffle3(dst, src, pixels, order);
+  }
+  if constexpr (!Mapped && Channels == 4) {
+    return PixelSIMD::shuffle4(dst, src, pixels, order);
+  }
+
+  const uint8_t o0 = order[0], o1 = order[1], o2 = order[2];
+  uint32_t sum = 0;
+  for (size_t i = 0; i < pixels; ++i, src += Channels) {
+    uint8_t px[Channels];
+    px[0] = src[o0];
+    px[1] = src[o1];
+    px[2] = src[o2];
+    if constexpr (Channels == 4) px[3] = src[3];
+    for (uint8_t k = 0; k < Channels; ++k) sum += px[k];
+
+    if constexpr (Mapped) {
+      for (uint8_t g = 0; g < group; ++g) {
+        memcpy(dst + *map++ * Channels, px, Channels);
+      }
+    } else {
+      memcpy(dst, px, Channels);
+      dst += Channels;
+    }
+  }
+  return Mapped ? sum * group : sum;
+}
+
+// 16-bit pipeline: levels are widened through the strip's WideTable into
+// sLevels (wire order), then dithered down to the wire bytes. Sources send
+// either 8-bit levels or coarse/fine channel pairs.
+typedef uint32_t (*WideKernel)(uint16_t *dst, const uint8_t *src, size_t pixels, const uint8_t *order,
+                           const PixelLUT::WideTable *lut, const uint16_t *map, uint8_t group);
+
+template <uint8_t Channels, bool Input16, bool Mapped>
+static uint32_t widen(uint16_t *dst, const uint8_t *src, size_t pixels, const uint8_t *order,
+                  const PixelLUT::WideTable *lut, const uint16_t *map, uint8_t group) {
+  constexpr uint8_t kSourceStride = Channels * (Input16 ? 2 : 1);
+  uint32_t sum = 0;
+  for (size_t i = 0; i < pixels; ++i, src += kSourceStride) {
+    uint16_t px[Channels];
+    for (uint8_t k = 0; k < Channels; ++k) {
+      uint8_t channel = k < 3 ? order[k] : 3;
+      if constexpr (Input16) {
+        const uint8_t *pair = src + 2 * channel;
+        px[k] = PixelLUT::lookupWide(lut[k], (pair[0] << 8) | pair[1]);
+      } else {
+        px[k] = lut[k][src[channel]];
+      }
+      sum += px[k] >> 8;
+    }
+
+    if constexpr (Mapped) {
+      for (uint8_t g = 0; g < group; ++g) {
+        memcpy(dst + *map++ * Channels, px, sizeof(px));
+      }
+    } else {
+      memcpy(dst, px, sizeof(px));
+      dst += Channels;
+    }
+  }
+  return Mapped ? sum * group : sum;
+}
+
+// Temporal error diffusion (PixelSIMD::dither16): each wire byte keeps the fraction it dropped
+// last frame and adds it back before truncating, so a 16-bit level averages
+// out over successive frames. The residues start from a 4×4 Bayer pattern
+// so neighbouring pixels do not step on the same frame.
+static constexpr uint8_t kDitherSeed[16] = {
+  0, 128, 32, 160, 192, 64, 224, 96, 48, 176, 16, 144, 240, 112, 208, 80
+};
+
+// Undithered wide strips round to nearest and have no residue.
+static void roundLevels(uint8_t *dst, const uint16_t *src, uint8_t *, size_t count) {
+  PixelSIMD::round16(dst, src, count);
+}
+
+// Each output owns a contiguous run of the wire buffers and reads its
+// levels from a fixed offset in the universe buffer. FastLED starts every
+// RMT channel before waiting, so strips clock out in parallel and a frame
+// takes as long as the longest strip.
+struct Strip {
+  CLEDController *controller {nullptr};
+  size_t firstUnit {0};      // index into the wire buffers
+  uint16_t units {0};
+  uint16_t first {0};        // logical pixel index, for FX renders
+  uint16_t count {0};
+  size_t sourceOffset {0};   // byte offset of the first pixel in the universe buffer
+  uint16_t startUniverse {0}; // 0 = follows the previous output
+  uint16_t startChannel {1};
+  uint8_t stride {3};         // wire bytes per pixel
+  uint8_t sourceStride {3};   // universe bytes per pixel
+  uint8_t order[3] {0, 1, 2}; // wire byte k carries source channel order[k]
+  CopyKernel copy {copy8<3, false>};
+  CopyKernel lutCopy {copy8<3, false>};
+  CopyKernel passCopy {pass8<3, false>};
+
+  // Mapping compiled from the output config; empty for a plain linear strip.
+  std::vector<uint16_t> map;
+  uint8_t group {1};
+  uint16_t sourcePixels {0};  // pixels read from the universe buffer
+
+  bool wide {false};          // 16-bit pipeline through sLevels
+  bool dither {false};
+  WideKernel widen {nullptr};
+  void (*narrow)(uint8_t *dst, const uint16_t *src, uint8_t *residue, size_t count) {roundLevels};
+
+  const PixelLUT::GammaTable *gamma {&PixelLUT::kLinear};
+  PixelLUT::GammaTable customGamma {};
+  uint8_t balance[4] {255, 255, 255, 255};      // R, G, B, W
+  std::array<PixelLUT::ChannelTable, 4> lut {};  // by wire position
+  std::array<PixelLUT::WideTable, 4> wideLut {};
+  int16_t lutBrightness {-1};                   // brightness the tables were built for
+  uint32_t levelSum {0};      // 8-bit wire level sum of the strip as rendered
+  bool sumStale {false};      // only part of the strip was rewritten
+};
+static std::array<Strip, Prizm::kMaxPixelOutputs> sStrips {};
+static uint8_t sStripCount = 0;
+
+template <uint8_t Channels, bool Mapped>
+static WideKernel wideKernel(bool input16) {
+  return input16 ? widen<Channels, true, Mapped> : widen<Channels, false, Mapped>;
+}
+
+template <uint8_t Channels>
+static void selectKernels(Strip &strip, bool input16) {
+  if (strip.map.empty()) {
+    strip.lutCopy = copy8<Channels, false>;
+    strip.passCopy = pass8<Channels, false>;
+    strip.widen = wideKernel<Channels, false>(input16);
+  } else {
+    strip.lutCopy = copy8<Channels, true>;
+    strip.passCopy = pass8<Channels, true>;
+    strip.widen = wideKernel<Channels, true>(input16);
+  }
+  strip.copy = strip.lutCopy;
+}
+
+// Compiles reverse/serpentine/grouping/null pixels into the strip's LED
+// table. Logical pixel j (source pixel j / group) lands on physical LED
+// nulls + f(j); trailing entries of a short last group repeat the last LED.
+static void buildMap(Strip &strip, const Prizm::PixelOutputConfig &out) {
+  uint16_t nulls = std::min(out.nullPixels, strip.count);
+  uint16_t active = strip.count - nulls;
+  strip.group = std::max<uint8_t>(out.group, 1);
+  strip.sourcePixels = (active + strip.group - 1) / strip.group;
+  strip.map.clear();
+
+  bool linear = !out.reverse && !(out.serpentine && out.width > 0) && strip.group == 1 && nulls == 0;
+  if (linear || active == 0) {
+    strip.map.shrink_to_fit();
+    return;
+  }
+
+  strip.map.resize(static_cast<size_t>(strip.sourcePixels) * strip.group);
+  for (size_t j = 0; j < strip.map.size(); ++j) {
+    uint16_t logical = std::min<size_t>(j, active - 1);
+    uint16_t pos = logical;
+    if (out.serpentine && out.width > 0) {
+      uint16_t row = logical / out.width;
+      uint16_t col = logical % out.width;
+      uint16_t rowStart = row * out.width;
+      uint16_t rowLength = std::min<uint16_t>(out.width, active - rowStart); // last row may be short
+      if (row & 1) col = rowLength - 1 - col;
+      pos = rowStart + col;
+    }
+    if (out.reverse) pos = active - 1 - pos;
+    strip.map[j] = nulls + pos;
+  }
+
+  // Every active LED must be driven by exactly one logical pixel.
+  std::vector<bool> seen(active, false);
+  for (uint16_t j = 0; j < active; ++j) {
+    uint16_t pos = strip.map[j] - nulls;
+    if (strip.map[j] < nulls || pos >= active || seen[pos]) {
+      Debug::error("PIX", "LED map is not a permutation at pixel %u, using linear order", j);
+      for (uint16_t k = 0; k < strip.map.size(); ++k) {
+        strip.map[k] = nulls + std::min<uint16_t>(k, active - 1);
+      }
+      return;
+    }
+    seen[pos] = true;
+  }
+}
+
+static PixelPower::Budget sPowerBudget;
+static uint16_t sPowerFactor = 256;       // applied on the copy to the wire
+static uint8_t sPowerScale = 255;         // last limiter scale, 255 = not limiting
+static bool sLimited = false;
+static uint32_t sMilliamps = 0;
+static uint32_t sLimitedFrames = 0;
+
+static uint16_t *sLevels = nullptr;     // 16-bit wire-order levels, wide strips only
+static uint8_t *sResidue = nullptr;     // dither error carried between frames
+static bool sDitherActive = false;
+
+// Double buffering: the show task clocks out the front buffer (the one the
+// controllers point at) while loop() renders the next frame into sLeds. A
+// frame is copied to the front only while the show task is idle, scaled by
+// the current limiter on the way, so the render buffer always holds the
+// unlimited frame. Rendered frames are marked dirty and pushed on the next
+// frame-clock tick; a dirty frame that is rendered over before then is
+// counted as dropped.
+static CRGB *sBuffers[2] = {nullptr, nullptr};
+static CRGB *sFront = nullptr;
+static TaskHandle_t sShowTask = nullptr;
+static std::atomic<bool> sShowing {false};
+static bool sDirty = false;
+static bool sBusyCounted = false;
+static uint32_t sFrameIntervalUs = 0;   // 0 = push as soon as the wire is free
+static uint32_t sLastShowUs = 0;
+static std::atomic<uint32_t> sFramesShown {0};
+static uint32_t sFramesBusy = 0;
+static uint32_t sFramesDropped = 0;
+static bool sBlackedOut = false;        // back buffer holds a blackout, nothing rendered since
+static int16_t sRenderedBrightness = -1; // brightness of the held source frame, -1 = none or stale
+
+constexpr BaseType_t kShowTaskCore = 1;
+constexpr UBaseType_t kShowTaskPriority = 2;  // above loop() so a finished frame is reported promptly
+constexpr uint32_t kShowTaskStack = 3072;
+
+static void showTask(void *) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    FastLED.show();
+    sFramesShown++;
+    sShowing.store(false, std::memory_order_release);
+  }
+}
+
+// Rebuilds the strip's tables only when the master brightness moves.
+static void setBrightness(Strip &strip, uint8_t brightness) {
+  if (strip.lutBrightness == brightness) return;
+  for (uint8_t k = 0; k < strip.stride; ++k) {
+    uint8_t channel = k < 3 ? strip.order[k] : 3;
+    if (strip.wide) {
+      PixelLUT::buildWide(strip.wideLut[k], *strip.gamma, strip.balance[channel], brightness);
+    } else {
+      PixelLUT::build(strip.lut[k], *strip.gamma, strip.balance[channel], brightness);
+    }
+  }
+  strip.lutBrightness = brightness;
+
+  bool identity = !strip.wide;
+  for (uint8_t k = 0; identity && k < strip.stride; ++k) {
+    for (int i = 0; i < 256 && identity; ++i) identity = strip.lut[k][i] == i;
+  }
+  strip.copy = identity ? strip.passCopy : strip.lutCopy;
+}
+
+static uint8_t *wireBytes(CRGB *buffer, const Strip &strip) {
+  return reinterpret_cast<uint8_t*>(buffer + strip.firstUnit);
+}
+
+static size_t levelOffset(const Strip &strip) {
+  return strip.firstUnit * 3;
+}
+
+static void narrowStrip(const Strip &strip) {
+  size_t offset = levelOffset(strip);
+  strip.narrow(wireBytes(sLeds, strip), sLevels + offset, sResidue + offset,
+               static_cast<size_t>(strip.count) * strip.stride);
+}
+
+// FailsafeFX draws logical RGB; reorder it into the strip's wire format
+// with the white channel left dark. Returns the level sum like the kernels.
+static uint32_t packRender(const Strip &strip) {
+  const CRGB *src = sRender + strip.first;
+  uint32_t sum = 0;
+  if (strip.wide) {
+    uint16_t *dst = sLevels + levelOffset(strip);
+    for (uint16_t i = 0; i < strip.count; ++i, dst += strip.stride) {
+      for (uint8_t k = 0; k < 3; ++k) {
+        dst[k] = strip.wideLut[k][src[i][strip.order[k]]];
+        sum += dst[k] >> 8;
+      }
+      if (strip.stride == 4) dst[3] = 0;
+    }
+    return sum;
+  }
+
+  uint8_t *dst = wireBytes(sLeds, strip);
+  for (uint16_t i = 0; i < strip.count; ++i, dst += strip.stride) {
+    dst[0] = strip.lut[0][src[i][strip.order[0]]];
+    dst[1] = strip.lut[1][src[i][strip.order[1]]];
+    dst[2] = strip.lut[2][src[i][strip.order[2]]];
+    if (strip.stride == 4) dst[3] = 0;
+    sum += dst[0] + dst[1] + dst[2];
+  }
+  return sum;
+}
+
+// Power limiting. The estimate covers every strip as it stands in the render
+// buffer: kernels hand back the sum of a strip they rewrote in full, and a
+// strip only partly rewritten is summed again. The resulting scale is only
+// applied to the copy on the wire.
+static void limitPower(uint32_t levelSum) {
+  PixelPower::Estimate estimate = PixelPower::limit(sPowerBudget, levelSum);
+  sPowerFactor = estimate.factor;
+  sLimited = estimate.factor < 256;
+  sPowerScale = sLimited ? estimate.factor : 255;
+  if (sLimited) sLimitedFrames++;
+  sMilliamps = estimate.milliamps;
+}
+
+// Narrows the wide strips, once per rendered frame so the dither residue
+// advances exactly one step, then updates the limiter.
+static void finishFrame() {
+  uint32_t levelSum = 0;
+  for (uint8_t s = 0; s < sStripCount; ++s) {
+    Strip &strip = sStrips[s];
+    if (strip.wide) narrowStrip(strip);
+    if (strip.sumStale) {
+      strip.levelSum = PixelSIMD::sum8(wireBytes(sLeds, strip),
+                                       static_cast<size_t>(strip.count) * strip.stride);
+      strip.sumStale = false;
+    }
+    levelSum += strip.levelSum;
+  }
+  limitPower(levelSum);
+}
+
+static void kick() {
+  sShowing.store(true, std::memory_order_release);
+  xTaskNotifyGive(sShowTask);
+}
+
+static bool frameDue(uint32_t nowUs) {
+  if (sFrameIntervalUs != 0 && nowUs - sLastShowUs < sFrameIntervalUs) return false;
+  return !sShowTask || !sShowing.load(std::memory_order_acquire);
+}
+
+// Copies the dirty render buffer to the front, limited, and pushes it if the
+// frame clock allows and it differs from what is already on the strip.
+static void flush(uint32_t nowUs) {
+  if (!sDirty) return;
+  if (!frameDue(nowUs)) {
+    if (sShowTask && sShowing.load(std::memory_order_relaxed) && !sBusyCounted) {
+      sFramesBusy++;
+      sBusyCounted = true;
+    }
+    return;
+  }
+  sDirty = false;
+  sBusyCounted = false;
+
+  bool changed = PixelSIMD::scaleCopy8(reinterpret_cast<uint8_t*>(sFront),
+                                       reinterpret_cast<const uint8_t*>(sLeds),
+                                       sizeof(CRGB) * sWireUnits, sPowerFactor);
+  if (!changed) return;
+
+  sLastShowUs = nowUs;
+  if (sShowTask) {
+    kick();
+  } else {
+    FastLED.show();
+    sFramesShown++;
+  }
+}
+
+static void present() {
+  if (sDirty) sFramesDropped++;
+  sBlackedOut = false;
+  sDirty = true;
+  flush(micros());
+}
+
+// FastLED keeps one controller per addLeds<> instantiation, and its RMT
+// driver gives each controller its own channel. The data pin is a template
+// argument, so the configured pin is dispatched at run time onto one
+// instantiation per usable ESP32-S3 GPIO (flash/PSRAM and absent pins left out).
+using PixelPins = std::integer_sequence<uint8_t, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+                                        15, 16, 17, 18, 21, 38, 39, 40, 41, 42, 43, 44, 45, 46,
+                                        47, 48>;
+
+template <uint8_t Pin>
+static CLEDController *addOnPin(Prizm::PixelChipset chipset, CRGB *leds, uint16_t units) {
+  if (chipset == Prizm::PixelChipset::SK6812) {
+    return &FastLED.addLeds<SK6812, Pin, RGB>(leds, units);
+  }
+  return &FastLED.addLeds<WS2812B, Pin, RGB>(leds, units);
+}
+
+template <uint8_t... Pins>
+static CLEDController *addController(Prizm::PixelChipset chipset, uint8_t pin, CRGB *leds,
+                                     uint16_t units, std::integer_sequence<uint8_t, Pins...>) {
+  CLEDController *controller = nullptr;
+  ((pin == Pins && (controller = addOnPin<Pins>(chipset, leds, units))) || ...);
+  return controller;  // null: the pin cannot drive pixels
+}
+
+template <uint8_t... Pins>
+static bool pixelPin(uint8_t pin, std::integer_sequence<uint8_t, Pins...>) {
+  return ((pin == Pins) || ...);
+}
+
+static void setOrder(Strip &strip, Prizm::ColorOrder order) {
+  static const uint8_t kOrders[][3] = {
+    {0, 1, 2},  // RGB
+    {0, 2, 1},  // RBG
+    {1, 0, 2},  // GRB
+    {1, 2, 0},  // GBR
+    {2, 0, 1},  // BRG
+    {2, 1, 0},  // BGR
+  };
+  memcpy(strip.order, kOrders[static_cast<uint8_t>(order)], sizeof(strip.order));
+}
+
+void setSourceLayout(uint16_t startUniverse, uint16_t channelsPerUniverse) {
+  size_t stride = std::min<uint16_t>(std::max<uint16_t>(channelsPerUniverse, 1), 512);
+  size_t nextOffset = 0;
+  for (uint8_t i = 0; i < sStripCount; ++i) {
+    Strip &strip = sStrips[i];
+    strip.sourceOffset = nextOffset;
+    if (strip.startUniverse >= startUniverse && strip.startUniverse != 0) {
+      strip.sourceOffset = (strip.startUniverse - startUniverse) * stride + (strip.startChannel - 1);
+    } else if (strip.startUniverse != 0) {
+      Debug::warn("PIX", "Output %u universe %u below e131 start", i, strip.startUniverse);
+    }
+    nextOffset = strip.sourceOffset + static_cast<size_t>(strip.sourcePixels) * strip.sourceStride;
+  }
+  sRenderedBrightness = -1;
+}
+
+bool begin(const Prizm::PixelConfig &cfg, const Prizm::E131Config &e131) {
   if (!cfg.enabled) {
     Debug::warn("PIX", "Pixel output disabled via config");
     sReady = false;
     return false;
   }
 
-  sPixelCount = cfg.count;
-  sHasWhite = cfg.useWhiteChannel;
+  sPixelCount = Prizm::totalPixels(cfg);
+  sStripCount = std::min<uint8_t>(cfg.outputCount, Prizm::kMaxPixelOutputs);
+  sWireUnits = 0;
+  for (uint8_t i = 0; i < sStripCount; ++i) {
+    size_t stride = cfg.outputs[i].chipset == Prizm::PixelChipset::SK6812 ? 4 : 3;
+    sWireUnits += (cfg.outputs[i].count * stride + 2) / 3;
+  }
+  bool anyWide = false;
+  for (uint8_t i = 0; i < sStripCount; ++i) {
+    anyWide |= cfg.outputs[i].dither || cfg.outputs[i].input16;
+  }
+  for (uint8_t i = 0; i < sStripCount; ++i) {
+    uint8_t pin = cfg.outputs[i].dataPin;
+    if (!pixelPin(pin, PixelPins{})) {
+      Debug::error("PIX", "Output %u: GPIO%u cannot drive pixels", i, pin);
+      sReady = false;
+      return false;
+    }
+    for (uint8_t j = 0; j < i; ++j) {
+      if (cfg.outputs[j].dataPin == pin) {
+        Debug::error("PIX", "Outputs %u and %u share GPIO%u", j, i, pin);
+        sReady = false;
+        return false;
+      }
+    }
+  }
   sBaseBrightness = cfg.brightness;
+  sPowerBudget.maxMilliamps = cfg.maxMilliamps;
+  sPowerBudget.milliampsPerChannel = cfg.milliampsPerChannel;
+  sPowerBudget.idleMilliamps = static_cast<uint32_t>(sPixelCount) * cfg.idleMilliamps;
+  sPowerFactor = 256;
+  sPowerScale = 255;
+  sFrameIntervalUs = cfg.maxFps ? 1000000UL / cfg.maxFps : 0;
+
+  for (CRGB *&buffer : sBuffers) {
+    if (!buffer) {
+      buffer = static_cast<CRGB*>(malloc(sizeof(CRGB) * sWireUnits));
+    }
+  }
+  if (!sRender) {
+    sRender = static_cast<CRGB*>(malloc(sizeof(CRGB) * sPixelCount));
+  }
 
-  if (!sLeds) {
-    sLeds = static_cast<CRGB*>(malloc(sizeof(CRGB) * sPixelCount));
+  size_t levelCount = sWireUnits * 3;
+  if (anyWide && !sLevels) {
+    sLevels = static_cast<uint16_t*>(calloc(levelCount, sizeof(uint16_t)));
+    sResidue = static_cast<uint8_t*>(malloc(levelCount));
   }
 
-  if (!sLeds) {
+  if (!sBuffers[0] || !sBuffers[1] || !sRender || (anyWide && (!sLevels || !sResidue))) {
     Debug::error("PIX", "Failed to alloc %u pixels", sPixelCount);
     sReady = false;
     return false;
   }
+  std::fill_n(sBuffers[0], sWireUnits, CRGB(0, 0, 0));
+  std::fill_n(sBuffers[1], sWireUnits, CRGB(0, 0, 0));
+  sFront = sBuffers[0];
+  sLeds = sBuffers[1];
 
-  if (sHasWhite) {
-    auto &controller = FastLED.addLeds<SK6812, 0, GRBW>(sLeds, sPixelCount);
-    controller.setPin(cfg.dataPin);
-  } else {
-    auto &controller = FastLED.addLeds<WS2812B, 0, GRB>(sLeds, sPixelCount);
-    controller.setPin(cfg.dataPin);
+  size_t firstUnit = 0;
+  uint16_t first = 0;
+  sDitherActive = false;
+  for (uint8_t i = 0; i < sStripCount; ++i) {
+    const Prizm::PixelOutputConfig &out = cfg.outputs[i];
+    Strip &strip = sStrips[i];
+    strip.first = first;
+    strip.count = out.count;
+    strip.stride = out.chipset == Prizm::PixelChipset::SK6812 ? 4 : 3;
+    strip.wide = out.dither || out.input16;
+    strip.dither = out.dither;
+    strip.sourceStride = strip.stride * (out.input16 ? 2 : 1);
+    buildMap(strip, out);
+    if (strip.stride == 4) {
+      selectKernels<4>(strip, out.input16);
+    } else {
+      selectKernels<3>(strip, out.input16);
+    }
+    strip.narrow = out.dither ? PixelSIMD::dither16 : roundLevels;
+    sDitherActive |= out.dither;
+    strip.firstUnit = firstUnit;
+    strip.units = (strip.count * strip.stride + 2) / 3;
+    setOrder(strip, out.order);
+    strip.gamma = &PixelLUT::gammaTable(out.gamma, strip.customGamma);
+    memcpy(strip.balance, out.balance.data(), sizeof(strip.balance));
+    strip.lutBrightness = -1;
+    strip.levelSum = 0;
+    strip.sumStale = false;
+    strip.startUniverse = out.startUniverse;
+    strip.startChannel = out.startChannel;
+    first += strip.count;
+    firstUnit += strip.units;
+    if (strip.wide) {
+      uint8_t *residue = sResidue + levelOffset(strip);
+      for (size_t b = 0; b < static_cast<size_t>(strip.count) * strip.stride; ++b) {
+        residue[b] = kDitherSeed[(b / strip.stride) & 0x0F];
+      }
+    }
+  }
+  setSourceLayout(e131.startUniverse, e131.channelsPerUniverse);
+
+  for (uint8_t i = 0; i < sStripCount; ++i) {
+    const Prizm::PixelOutputConfig &out = cfg.outputs[i];
+    Strip &strip = sStrips[i];
+    strip.controller = addController(out.chipset, out.dataPin, sFront + strip.firstUnit,
+                                     strip.units, PixelPins{});
+    for (uint8_t j = 0; j < i; ++j) {
+      if (sStrips[j].controller == strip.controller) {
+        Debug::error("PIX", "Outputs %u and %u resolved to one controller", j, i);
+        sReady = false;
+        return false;
+      }
+    }
+    // Dithered outputs already carry their own temporal dither
+    // (PixelSIMD::dither16); FastLED's would be a second pass on top of it.
+    strip.controller->setDither(DISABLE_DITHER);
+    Debug::info("PIX", "Output %u: %u pixels on GPIO%u from offset %u%s", i, strip.count,
+                out.dataPin, static_cast<unsigned>(strip.sourceOffset),
+                strip.map.empty() ? "" : " (mapped)");
   }
-  FastLED.setBrightness(sBaseBrightness);
-  FastLED.clear();
+  FastLED.setBrightness(255); // brightness lives in the per-strip tables
+  FastLED.setDither(DISABLE_DITHER); // wire bytes go out exactly as the kernels wrote them
   FastLED.show();
 
-  Debug::info("PIX", "Configured %u pixels", sPixelCount);
+  if (!sShowTask &&
+      xTaskCreatePinnedToCore(showTask, "pixShow", kShowTaskStack, nullptr, kShowTaskPriority,
+                              &sShowTask, kShowTaskCore) != pdPASS) {
+    sShowTask = nullptr;
+    Debug::warn("PIX", "Show task failed to start, output is blocking");
+  }
+
+  Debug::info("PIX", "Configured %u pixels on %u outputs", sPixelCount, sStripCount);
   sReady = true;
   return true;
 }
 
+static uint8_t sourceBrightness(float brightnessScalar) {
+  return constrain(static_cast<int>(sBaseBrightness * brightnessScalar), 0, 255);
+}
+
 void updateFromE131(const uint8_t *data, size_t length, float brightnessScalar) {
   if (!sReady || !data) return;
 
-  size_t stride = sHasWhite ? 4 : 3;
-  size_t expectedBytes = static_cast<size_t>(sPixelCount) * stride;
-  size_t copyBytes = std::min(length, expectedBytes);
-  size_t pixels = copyBytes / stride;
-
-  for (size_t i = 0; i < pixels; ++i) {
-    size_t base = i * stride;
-    uint8_t r = data[base];
-    uint8_t g = data[base + 1];
-    uint8_t b = data[base + 2];
-    if (sHasWhite && base + 3 < length) {
-      uint8_t w = data[base + 3];
-      r = std::min<int>(255, r + w);
-      g = std::min<int>(255, g + w);
-      b = std::min<int>(255, b + w);
+  uint8_t brightness = sourceBrightness(brightnessScalar);
+  sRenderedBrightness = brightness;
+  for (uint8_t s = 0; s < sStripCount; ++s) {
+    Strip &strip = sStrips[s];
+    setBrightness(strip, brightness);
+    if (strip.sourceOffset >= length) continue;
+    const uint8_t *src = data + strip.sourceOffset;
+    size_t available = length - strip.sourceOffset;
+    size_t pixels = std::min<size_t>(available / strip.sourceStride, strip.sourcePixels);
+    if (strip.wide) {
+      strip.levelSum = strip.widen(sLevels + levelOffset(strip), src, pixels, strip.order,
+                                   strip.wideLut.data(), strip.map.data(), strip.group);
+    } else {
+      strip.levelSum = strip.copy(wireBytes(sLeds, strip), src, pixels, strip.order,
+                                  strip.lut.data(), strip.map.data(), strip.group);
     }
-    sLeds[i] = CRGB(r, g, b);
+    strip.sumStale = pixels < strip.sourcePixels;
   }
-
-  uint8_t brightness = constrain(static_cast<int>(sBaseBrightness * brightnessScalar), 0, 255);
-  FastLED.setBrightness(brightness);
-  FastLED.show();
+  finishFrame();
+  present();
 }
 
 void applyFailsafe(float brightnessScalar, uint32_t nowMs) {
   if (!sReady) return;
-  FailsafeFX::render(sLeds, sPixelCount, nowMs, brightnessScalar);
-  FastLED.show();
+  if (!frameDue(micros())) return; // time-based effect, nothing lost by skipping a render
+  FailsafeFX::render(sRender, sPixelCount, nowMs, brightnessScalar);
+  sRenderedBrightness = -1;
+  for (uint8_t s = 0; s < sStripCount; ++s) {
+    setBrightness(sStrips[s], sBaseBrightness); // the effect applies the scalar itself
+    sStrips[s].levelSum = packRender(sStrips[s]);
+  }
+  finishFrame();
+  present();
 }
 
+// Failsafe without FX calls this on every loop pass; only the first call
+// renders a frame, loop() pushes it when the frame clock allows.
 void blackout() {
-  if (!sReady) return;
-  FastLED.clear();
-  FastLED.show();
+  if (!sReady || sBlackedOut) return;
+  sRenderedBrightness = -1;
+  std::fill_n(sLeds, sWireUnits, CRGB(0, 0, 0));
+  if (sLevels) std::fill_n(sLevels, sWireUnits * 3, 0);
+  for (uint8_t s = 0; s < sStripCount; ++s) {
+    sStrips[s].levelSum = 0;
+    sStrips[s].sumStale = false;
+  }
+  limitPower(0);
+  present();
+  sBlackedOut = true;
 }
 
 void loop() {
   if (!sReady) return;
-  FastLED.delay(0);
+  uint32_t now = micros();
+  if (sDitherActive && !sDirty && frameDue(now)) {
+    // Keep cycling the dither on a static frame; flush() skips the push
+    // when every level is already exact.
+    for (uint8_t s = 0; s < sStripCount; ++s) {
+      if (sStrips[s].dither) narrowStrip(sStrips[s]);
+    }
+    sDirty = true;
+  }
+  flush(now);
+}
+
+bool needsRender(float brightnessScalar) {
+  if (!sReady || sDirty) return false;  // at most one re-render per pushed frame
+  return sRenderedBrightness != sourceBrightness(brightnessScalar);
 }
 
 bool isReady() { return sReady; }
 uint16_t pixelCount() { return sPixelCount; }
 
-} // namespace PixelOutput
+void sample(uint8_t *rgb, uint16_t samples) {
+  if (!sReady || sPixelCount == 0) {
+    memset(rgb, 0, static_cast<size_t>(samples) * 3);
+    return;
+  }
 
+  uint8_t s = 0;
+  for (uint16_t i = 0; i < samples; ++i, rgb += 3) {
+    uint16_t pixel = static_cast<uint32_t>(i) * sPixelCount / samples;
+    while (s + 1 < sStripCount && pixel >= sStrips[s].first + sStrips[s].count) ++s;
+    const Strip &strip = sStrips[s];
+    const uint8_t *wire = wireBytes(sFront, strip) + static_cast<size_t>(pixel - strip.first) * strip.stride;
+    uint8_t white = strip.stride == 4 ? wire[3] : 0;
+    for (uint8_t k = 0; k < 3; ++k) {
+      rgb[strip.order[k]] = std::min<uint16_t>(wire[k] + white, 255);
+    }
+  }
+}
+
+OutputStats stats() {
+  OutputStats out;
+  out.shown = sFramesShown;
+  out.busy = sFramesBusy;
+  out.dropped = sFramesDropped;
+  out.milliamps = sMilliamps;
+  out.limited = sLimited;
+  out.limitedFrames = sLimitedFrames;
+  out.powerScale = sPowerScale;
+  return out;
+}
+
+} // namespace PixelOutput
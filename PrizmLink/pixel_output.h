@@ -6,8 +6,32 @@
 
 namespace PixelOutput {
 
-bool begin(const Prizm::PixelConfig &cfg);
+struct OutputStats {
+  uint32_t shown {0};    // frames clocked out
+  uint32_t busy {0};     // frames presented while the previous one was on the wire
+  uint32_t dropped {0};  // renders replaced before they reached the wire
+  uint32_t milliamps {0};      // estimated draw of the last frame
+  bool limited {false};        // current limiter is holding brightness down
+  uint32_t limitedFrames {0};
+  uint8_t powerScale {255};    // limiter scale, 255 = unlimited
+};
+
+// Registers one FastLED controller per configured output, allocates
+// front/back pixel buffers covering all of them and starts the show task.
+// Each output reads from its start universe/channel within the universe
+// buffer described by `e131`. The render
+// calls below fill the back buffer and mark it dirty; it is pushed at most
+// once per PixelConfig::maxFps tick, only if it changed, and without waiting
+// for the wire unless the task could not be started.
+bool begin(const Prizm::PixelConfig &cfg, const Prizm::E131Config &e131);
+// Recomputes each output's offset for a new universe layout (see
+// NetworkE131::frameLayout()).
+void setSourceLayout(uint16_t startUniverse, uint16_t channelsPerUniverse);
 void updateFromE131(const uint8_t *data, size_t length, float brightnessScalar = 1.0f);
+// True when the source frame last rendered should be rendered again without
+// new data: the brightness it would get has moved, or the tables or layout
+// were rebuilt since.
+bool needsRender(float brightnessScalar);
 void applyFailsafe(float brightnessScalar, uint32_t nowMs);
 void blackout();
 
@@ -16,5 +40,11 @@ void loop();
 bool isReady();
 uint16_t pixelCount();
 
+// Nearest-pixel downsample of the latest rendered frame to `samples` RGB
+// triplets, in physical LED order across all outputs. White is folded into
+// RGB for display.
+void sample(uint8_t *rgb, uint16_t samples);
+OutputStats stats();
+
 } // namespace PixelOutput
 
@@ -0,0 +1,19 @@
+#include "pixel_power.h"
+
+namespace PixelPower {
+
+Estimate limit(const Budget &budget, uint32_t levelSum) {
+  uint64_t contentMa = static_cast<uint64_t>(levelSum) * budget.milliampsPerChannel / 255;
+  uint32_t available =
+      budget.maxMilliamps > budget.idleMilliamps ? budget.maxMilliamps - budget.idleMilliamps : 0;
+
+  Estimate out;
+  if (budget.maxMilliamps != 0 && contentMa > available) {
+    out.factor = static_cast<uint16_t>((static_cast<uint64_t>(available) << 8) / contentMa);
+    contentMa = contentMa * out.factor >> 8;
+  }
+  out.milliamps = static_cast<uint32_t>(contentMa) + budget.idleMilliamps;
+  return out;
+}
+
+} // namespace PixelPower
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+// Current limiter arithmetic for PixelOutput, with no Arduino dependency.
+// The estimate comes from the sum of the 8-bit wire levels; the result is a
+// scale8 factor that PixelOutput applies while copying a frame to the wire,
+// so the render buffers themselves are never scaled.
+namespace PixelPower {
+
+struct Budget {
+  uint32_t maxMilliamps {0};          // 0 = no limit
+  uint32_t milliampsPerChannel {20};  // one channel at full level
+  uint32_t idleMilliamps {0};         // quiescent draw of the whole chain
+};
+
+struct Estimate {
+  uint16_t factor {256};   // 256 = within budget, send unscaled
+  uint32_t milliamps {0};  // draw once the factor is applied
+};
+
+// Scale that brings a frame whose wire levels sum to `levelSum` inside the
+// budget, rounded down so the scaled frame never exceeds it.
+Estimate limit(const Budget &budget, uint32_t levelSum);
+
+} // namespace PixelPower
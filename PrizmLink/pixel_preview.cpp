@@ -0,0 +1,62 @@
+#include "pixel_preview.h"
+
+#include <cstring>
+
+namespace PixelPreview {
+
+static bool samePixel(const uint8_t *a, const uint8_t *b) {
+  return a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+}
+
+size_t encode(uint8_t *out, const uint8_t *rgb, const uint8_t *previous, uint16_t pixels) {
+  uint8_t *p = out + kHeaderSize;
+  uint8_t *literal = nullptr;  // control byte of the open literal run
+  bool changed = false;
+
+  size_t i = 0;
+  while (i < pixels) {
+    const uint8_t *px = rgb + i * 3;
+
+    if (previous && samePixel(px, previous + i * 3)) {
+      size_t len = 1;
+      while (i + len < pixels && len < kMaxRun && samePixel(rgb + (i + len) * 3, previous + (i + len) * 3)) {
+        ++len;
+      }
+      literal = nullptr;
+      *p++ = kRunUnchanged | (len - 1);
+      i += len;
+      continue;
+    }
+
+    changed = true;
+    size_t len = 1;
+    while (i + len < pixels && len < kMaxRun && samePixel(rgb + (i + len) * 3, px)) ++len;
+    if (len >= 2) {
+      literal = nullptr;
+      *p++ = kRunRepeat | (len - 1);
+      memcpy(p, px, 3);
+      p += 3;
+      i += len;
+      continue;
+    }
+
+    if (!literal || (*literal & 0x3F) == kMaxRun - 1) {
+      literal = p++;
+      *literal = kRunLiteral;
+    } else {
+      ++*literal;
+    }
+    memcpy(p, px, 3);
+    p += 3;
+    ++i;
+  }
+
+  if (previous && !changed) return 0;
+  out[0] = kMagic;
+  out[1] = previous ? kFlagDelta : 0;
+  out[2] = pixels & 0xFF;
+  out[3] = pixels >> 8;
+  return p - out;
+}
+
+}  // namespace PixelPreview
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Binary encoding for the live pixel preview sent over the web socket.
+//
+//   byte 0    'P'
+//   byte 1    flags (kFlagDelta: runs apply to the client's previous frame)
+//   byte 2-3  pixel count, little endian
+//   then runs, each starting with a control byte whose low 6 bits hold
+//   length - 1 (1..64 pixels):
+//     00 → that many RGB triplets follow
+//     01 → one RGB triplet follows, repeated
+//     10 → pixels unchanged from the previous frame (delta frames only)
+namespace PixelPreview {
+
+constexpr uint8_t kMagic = 'P';
+constexpr uint8_t kFlagDelta = 0x01;
+constexpr size_t kHeaderSize = 4;
+
+constexpr uint8_t kRunLiteral = 0x00;
+constexpr uint8_t kRunRepeat = 0x40;
+constexpr uint8_t kRunUnchanged = 0x80;
+constexpr uint8_t kMaxRun = 64;
+
+constexpr size_t maxEncodedSize(uint16_t pixels) {
+  return kHeaderSize + static_cast<size_t>(pixels) * 4;
+}
+
+// Encodes `pixels` RGB triplets into `out` (at least maxEncodedSize bytes).
+// With `previous` set, a delta frame is written and 0 is returned if nothing
+// changed; otherwise a key frame. Returns the encoded length.
+size_t encode(uint8_t *out, const uint8_t *rgb, const uint8_t *previous, uint16_t pixels);
+
+}  // namespace PixelPreview
@@ -0,0 +1,185 @@
+#include "pixel_simd.h"
+
+#include <cstring>
+
+namespace PixelSIMD {
+
+static constexpr uint32_t kEvenBytes = 0x00FF00FF;
+
+static inline uint32_t load(const uint8_t *p) {
+  uint32_t w;
+  memcpy(&w, p, sizeof(w));
+  return w;
+}
+
+static inline void store(uint8_t *p, uint32_t w) {
+  memcpy(p, &w, sizeof(w));
+}
+
+// Word loop over the aligned middle of a buffer; ragged ends go bytewise.
+static inline size_t head(const uint8_t *p, size_t len) {
+  size_t misalign = reinterpret_cast<uintptr_t>(p) & 3;
+  size_t n = misalign ? 4 - misalign : 0;
+  return n < len ? n : len;
+}
+
+uint32_t sum8(const uint8_t *data, size_t len) {
+  uint32_t sum = 0;
+  size_t lead = head(data, len);
+  for (size_t i = 0; i < lead; ++i) sum += data[i];
+  data += lead;
+  len -= lead;
+
+  // Two 16-bit lanes per accumulator; each word adds at most 2 × 255 per
+  // lane, so fold before 128 words can overflow one.
+  while (len >= 4) {
+    size_t words = len / 4;
+    if (words > 128) words = 128;
+    uint32_t lanes = 0;
+    for (size_t i = 0; i < words; ++i, data += 4) {
+      uint32_t w = load(static_cast<const uint8_t*>(__builtin_assume_aligned(data, 4)));
+      lanes += (w & kEvenBytes) + ((w >> 8) & kEvenBytes);
+    }
+    sum += (lanes & 0xFFFF) + (lanes >> 16);
+    len -= words * 4;
+  }
+
+  for (size_t i = 0; i < len; ++i) sum += data[i];
+  return sum;
+}
+
+void scale8(uint8_t *data, size_t len, uint16_t factor) {
+  if (factor >= 256) return;
+  size_t lead = head(data, len);
+  for (size_t i = 0; i < lead; ++i) data[i] = (data[i] * factor) >> 8;
+  data += lead;
+  len -= lead;
+
+  // Two bytes per multiply: each 8-bit lane times a ≤ 8-bit factor fits
+  // in its 16-bit slot, so the lanes never carry into each other.
+  for (; len >= 4; len -= 4, data += 4) {
+    uint8_t *p = static_cast<uint8_t*>(__builtin_assume_aligned(data, 4));
+    uint32_t w = load(p);
+    uint32_t even = (((w & kEvenBytes) * factor) >> 8) & kEvenBytes;
+    uint32_t odd = (((w >> 8) & kEvenBytes) * factor) & ~kEvenBytes;
+    store(p, even | odd);
+  }
+
+  for (size_t i = 0; i < len; ++i) data[i] = (data[i] * factor) >> 8;
+}
+
+bool scaleCopy8(uint8_t *dst, const uint8_t *src, size_t len, uint16_t factor) {
+  if (factor >= 256) {
+    if (memcmp(dst, src, len) == 0) return false;
+    memcpy(dst, src, len);
+    return true;
+  }
+
+  uint32_t diff = 0;
+  size_t lead = head(dst, len);
+  for (size_t i = 0; i < lead; ++i) {
+    uint8_t level = (src[i] * factor) >> 8;
+    diff |= dst[i] ^ level;
+    dst[i] = level;
+  }
+  dst += lead;
+  src += lead;
+  len -= lead;
+
+  // Same lanes as scale8; the old word is compared on the way through.
+  if ((reinterpret_cast<uintptr_t>(src) & 3) == 0) {
+    for (; len >= 4; len -= 4, src += 4, dst += 4) {
+      uint8_t *p = static_cast<uint8_t*>(__builtin_assume_aligned(dst, 4));
+      uint32_t w = load(static_cast<const uint8_t*>(__builtin_assume_aligned(src, 4)));
+      uint32_t even = (((w & kEvenBytes) * factor) >> 8) & kEvenBytes;
+      uint32_t odd = (((w >> 8) & kEvenBytes) * factor) & ~kEvenBytes;
+      diff |= load(p) ^ (even | odd);
+      store(p, even | odd);
+    }
+  }
+
+  for (size_t i = 0; i < len; ++i) {
+    uint8_t level = (src[i] * factor) >> 8;
+    diff |= dst[i] ^ level;
+    dst[i] = level;
+  }
+  return diff != 0;
+}
+
+uint32_t shuffle3(uint8_t *dst, const uint8_t *src, size_t pixels, const uint8_t *order) {
+  if (order[0] == 0 && order[1] == 1 && order[2] == 2) {
+    memcpy(dst, src, pixels * 3);
+    return sum8(dst, pixels * 3);
+  }
+
+  // Four pixels per pass: twelve byte reads packed into three word stores.
+  const uint8_t o0 = order[0], o1 = order[1], o2 = order[2];
+  uint32_t sum = 0;
+  size_t i = 0;
+  for (; i + 4 <= pixels; i += 4, src += 12, dst += 12) {
+    uint32_t w0 = src[o0] | (src[o1] << 8) | (src[o2] << 16) | (src[3 + o0] << 24);
+    uint32_t w1 = src[3 + o1] | (src[3 + o2] << 8) | (src[6 + o0] << 16) | (src[6 + o1] << 24);
+    uint32_t w2 = src[6 + o2] | (src[9 + o0] << 8) | (src[9 + o1] << 16) | (src[9 + o2] << 24);
+    store(dst, w0);
+    store(dst + 4, w1);
+    store(dst + 8, w2);
+    uint32_t lanes = (w0 & kEvenBytes) + ((w0 >> 8) & kEvenBytes) +
+                     (w1 & kEvenBytes) + ((w1 >> 8) & kEvenBytes) +
+                     (w2 & kEvenBytes) + ((w2 >> 8) & kEvenBytes);
+    sum += (lanes & 0xFFFF) + (lanes >> 16);
+  }
+  for (; i < pixels; ++i, src += 3, dst += 3) {
+    dst[0] = src[o0];
+    dst[1] = src[o1];
+    dst[2] = src[o2];
+    sum += dst[0] + dst[1] + dst[2];
+  }
+  return sum;
+}
+
+uint32_t shuffle4(uint8_t *dst, const uint8_t *src, size_t pixels, const uint8_t *order) {
+  if (order[0] == 0 && order[1] == 1 && order[2] == 2) {
+    memcpy(dst, src, pixels * 4);
+    return sum8(dst, pixels * 4);
+  }
+
+  // One pixel per word store; the byte sum folds like sum8.
+  const uint8_t o0 = order[0], o1 = order[1], o2 = order[2];
+  uint32_t sum = 0;
+  while (pixels > 0) {
+    size_t words = pixels > 128 ? 128 : pixels;
+    uint32_t lanes = 0;
+    for (size_t i = 0; i < words; ++i, src += 4, dst += 4) {
+      uint32_t w = src[o0] | (src[o1] << 8) | (src[o2] << 16) | (static_cast<uint32_t>(src[3]) << 24);
+      store(dst, w);
+      lanes += (w & kEvenBytes) + ((w >> 8) & kEvenBytes);
+    }
+    sum += (lanes & 0xFFFF) + (lanes >> 16);
+    pixels -= words;
+  }
+  return sum;
+}
+
+// The narrowing kernels stay per element: with 16-bit inputs a word only
+// holds two lanes, and the carry and saturation masking costs more than the
+// byte loads it saves on a 32-bit core.
+void dither16(uint8_t *dst, const uint16_t *src, uint8_t *residue, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t sum = static_cast<uint32_t>(src[i]) + residue[i];
+    if (sum > 0xFFFF) {
+      dst[i] = 255;
+      continue;
+    }
+    dst[i] = sum >> 8;
+    residue[i] = sum & 0xFF;
+  }
+}
+
+void round16(uint8_t *dst, const uint16_t *src, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t level = (src[i] + 0x80U) >> 8;
+    dst[i] = level > 255 ? 255 : level;
+  }
+}
+
+}  // namespace PixelSIMD
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Byte-parallel helpers for the pixel buffers. They work four bytes per
+// 32-bit word (SIMD within a register), so they build unchanged for the
+// host and for any core, and give results bit-identical to the obvious
+// per-byte loops they replace; tests/test_pixel_simd.cpp holds those loops
+// as references.
+namespace PixelSIMD {
+
+// Sum of all bytes.
+uint32_t sum8(const uint8_t *data, size_t len);
+
+// data[i] = data[i] * factor >> 8, factor 0..256 (256 leaves data unchanged).
+void scale8(uint8_t *data, size_t len, uint16_t factor);
+
+// dst[i] = src[i] * factor >> 8, factor 0..256 (256 copies). Returns whether
+// any byte of dst changed.
+bool scaleCopy8(uint8_t *dst, const uint8_t *src, size_t len, uint16_t factor);
+
+// Reorders RGB source pixels into wire order: dst byte k of each pixel is
+// src byte order[k]. Returns the byte sum, like the LUT kernels.
+uint32_t shuffle3(uint8_t *dst, const uint8_t *src, size_t pixels, const uint8_t *order);
+
+// As shuffle3 for RGBW pixels; the white byte stays last.
+uint32_t shuffle4(uint8_t *dst, const uint8_t *src, size_t pixels, const uint8_t *order);
+
+// 16 → 8-bit narrowing for the wide pipeline. dither16 adds each byte's
+// residue before truncating and keeps the dropped fraction for the next
+// frame; a level that would pass 0xFFFF saturates to 255 and keeps its
+// residue. round16 rounds to nearest, saturating at 255.
+void dither16(uint8_t *dst, const uint16_t *src, uint8_t *residue, size_t count);
+void round16(uint8_t *dst, const uint16_t *src, size_t count);
+
+}  // namespace PixelSIMD
@@ -0,0 +1,196 @@
+#include <cstring>
+#include "rdm.h"
+
+namespace RDM {
+
+// Message layout (E1.20 §6.2)
+constexpr size_t kLengthOffset = 2;
+constexpr size_t kDestinationOffset = 3;
+constexpr size_t kSourceOffset = 9;
+constexpr size_t kTransactionOffset = 15;
+constexpr size_t kPortOffset = 16;
+constexpr size_t kMessageCountOffset = 17;
+constexpr size_t kSubDeviceOffset = 18;
+constexpr size_t kCommandClassOffset = 20;
+constexpr size_t kPidOffset = 21;
+constexpr size_t kDataLengthOffset = 23;
+
+constexpr uint8_t kPreamble = 0xFE;
+constexpr uint8_t kSeparator = 0xAA;
+constexpr size_t kMaxPreamble = 7;
+
+static inline uint16_t readU16(const uint8_t *p) {
+  return (static_cast<uint16_t>(p[0]) << 8) | p[1];
+}
+
+static inline void writeU16(uint8_t *p, uint16_t value) {
+  p[0] = value >> 8;
+  p[1] = value & 0xFF;
+}
+
+static inline uint32_t readU32(const uint8_t *p) {
+  return (static_cast<uint32_t>(readU16(p)) << 16) | readU16(p + 2);
+}
+
+static void writeUid(uint8_t *p, const Uid &uid) {
+  writeU16(p, uid.manufacturer);
+  writeU16(p + 2, uid.device >> 16);
+  writeU16(p + 4, uid.device & 0xFFFF);
+}
+
+static Uid readUid(const uint8_t *p) {
+  return Uid{readU16(p), readU32(p + 2)};
+}
+
+static uint16_t checksum(const uint8_t *data, size_t len) {
+  uint16_t sum = 0;
+  for (size_t i = 0; i < len; ++i) sum += data[i];
+  return sum;
+}
+
+size_t encode(uint8_t *out, size_t capacity, const Message &msg) {
+  size_t length = kHeaderLength + msg.dataLength;
+  if (msg.dataLength > kMaxDataLength || capacity < length + 2) return 0;
+
+  out[0] = kStartCode;
+  out[1] = kSubStartCode;
+  out[kLengthOffset] = length;
+  writeUid(&out[kDestinationOffset], msg.destination);
+  writeUid(&out[kSourceOffset], msg.source);
+  out[kTransactionOffset] = msg.transaction;
+  out[kPortOffset] = msg.portOrResponse;
+  out[kMessageCountOffset] = msg.messageCount;
+  writeU16(&out[kSubDeviceOffset], msg.subDevice);
+  out[kCommandClassOffset] = msg.commandClass;
+  writeU16(&out[kPidOffset], msg.pid);
+  out[kDataLengthOffset] = msg.dataLength;
+  if (msg.dataLength) memcpy(&out[kHeaderLength], msg.data, msg.dataLength);
+  writeU16(&out[length], checksum(out, length));
+  return length + 2;
+}
+
+bool decode(const uint8_t *data, size_t len, Message &msg) {
+  while (len > 0 && *data == 0x00) {
+    ++data;
+    --len;
+  }
+  if (len < kHeaderLength + 2) return false;
+  if (data[0] != kStartCode || data[1] != kSubStartCode) return false;
+
+  size_t length = data[kLengthOffset];
+  if (length < kHeaderLength || len < length + 2) return false;
+  if (data[kDataLengthOffset] != length - kHeaderLength) return false;
+  if (readU16(&data[length]) != checksum(data, length)) return false;
+
+  msg.destination = readUid(&data[kDestinationOffset]);
+  msg.source = readUid(&data[kSourceOffset]);
+  msg.transaction = data[kTransactionOffset];
+  msg.portOrResponse = data[kPortOffset];
+  msg.messageCount = data[kMessageCountOffset];
+  msg.subDevice = readU16(&data[kSubDeviceOffset]);
+  msg.commandClass = data[kCommandClassOffset];
+  msg.pid = readU16(&data[kPidOffset]);
+  msg.dataLength = data[kDataLengthOffset];
+  msg.data = msg.dataLength ? &data[kHeaderLength] : nullptr;
+  return true;
+}
+
+size_t encodeDiscoveryResponse(uint8_t *out, size_t capacity, const Uid &uid) {
+  if (capacity < kDiscoveryResponseLength) return 0;
+  uint8_t raw[6];
+  writeUid(raw, uid);
+
+  uint8_t *p = out;
+  for (size_t i = 0; i < kMaxPreamble; ++i) *p++ = kPreamble;
+  *p++ = kSeparator;
+  uint16_t sum = 0;
+  for (uint8_t b : raw) {
+    p[0] = b | 0xAA;
+    p[1] = b | 0x55;
+    sum += p[0] + p[1];
+    p += 2;
+  }
+  p[0] = (sum >> 8) | 0xAA;
+  p[1] = (sum >> 8) | 0x55;
+  p[2] = (sum & 0xFF) | 0xAA;
+  p[3] = (sum & 0xFF) | 0x55;
+  return kDiscoveryResponseLength;
+}
+
+bool decodeDiscoveryResponse(const uint8_t *data, size_t len, Uid &uid) {
+  size_t i = 0;
+  while (i < len && i < kMaxPreamble && data[i] == kPreamble) ++i;
+  if (i >= len || data[i] != kSeparator) return false;
+  ++i;
+  if (len - i < 16) return false;
+
+  const uint8_t *e = data + i;
+  uint8_t raw[6];
+  uint16_t sum = 0;
+  for (size_t k = 0; k < 6; ++k) {
+    raw[k] = e[2 * k] & e[2 * k + 1];
+    sum += e[2 * k] + e[2 * k + 1];
+  }
+  uint16_t received = (static_cast<uint16_t>(e[12] & e[13]) << 8) | (e[14] & e[15]);
+  if (received != sum) return false;
+  uid = readUid(raw);
+  return true;
+}
+
+static Message request(const Uid &source, const Uid &destination, uint8_t transaction,
+                       uint8_t commandClass, uint16_t pid) {
+  Message msg;
+  msg.source = source;
+  msg.destination = destination;
+  msg.transaction = transaction;
+  msg.commandClass = commandClass;
+  msg.pid = pid;
+  return msg;
+}
+
+size_t discUniqueBranch(uint8_t *out, size_t capacity, const Uid &source, uint8_t transaction,
+                        uint64_t lower, uint64_t upper) {
+  uint8_t bounds[12];
+  writeUid(bounds, Uid::fromValue(lower));
+  writeUid(bounds + 6, Uid::fromValue(upper));
+  Message msg = request(source, kBroadcast, transaction, Discovery, DiscUniqueBranch);
+  msg.data = bounds;
+  msg.dataLength = sizeof(bounds);
+  return encode(out, capacity, msg);
+}
+
+size_t discMute(uint8_t *out, size_t capacity, const Uid &source, const Uid &destination,
+                uint8_t transaction, bool mute) {
+  return encode(out, capacity, request(source, destination, transaction, Discovery,
+                                       mute ? DiscMute : DiscUnMute));
+}
+
+size_t get(uint8_t *out, size_t capacity, const Uid &source, const Uid &destination,
+           uint8_t transaction, uint16_t pid) {
+  return encode(out, capacity, request(source, destination, transaction, Get, pid));
+}
+
+size_t set(uint8_t *out, size_t capacity, const Uid &source, const Uid &destination,
+           uint8_t transaction, uint16_t pid, const uint8_t *data, uint8_t dataLength) {
+  Message msg = request(source, destination, transaction, Set, pid);
+  msg.data = data;
+  msg.dataLength = dataLength;
+  return encode(out, capacity, msg);
+}
+
+bool parseDeviceInfo(const uint8_t *data, size_t len, DeviceInfoData &out) {
+  if (!data || len < 19) return false;
+  out.protocolVersion = readU16(&data[0]);
+  out.model = readU16(&data[2]);
+  out.category = readU16(&data[4]);
+  out.softwareVersion = readU32(&data[6]);
+  out.footprint = readU16(&data[10]);
+  out.personality = data[12];
+  out.personalityCount = data[13];
+  out.startAddress = readU16(&data[14]);
+  out.subDevices = readU16(&data[16]);
+  out.sensors = data[18];
+  return true;
+}
+
+} // namespace RDM
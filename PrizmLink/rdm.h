@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// RDM (ANSI E1.20) message codec with no Arduino dependency. Encoders write
+// complete packets from the start code through the checksum; decoders work
+// in place on a received buffer.
+namespace RDM {
+
+constexpr uint8_t kStartCode = 0xCC;
+constexpr uint8_t kSubStartCode = 0x01;
+constexpr size_t kHeaderLength = 24;            // start code .. PDL
+constexpr size_t kMaxDataLength = 231;
+constexpr size_t kMaxMessageLength = kHeaderLength + kMaxDataLength + 2;
+constexpr size_t kDiscoveryResponseLength = 24; // 7 preamble + separator + EUID + ECS
+
+enum CommandClass : uint8_t {
+  Discovery = 0x10,
+  DiscoveryResponse = 0x11,
+  Get = 0x20,
+  GetResponse = 0x21,
+  Set = 0x30,
+  SetResponse = 0x31
+};
+
+enum ResponseType : uint8_t {
+  Ack = 0x00,
+  AckTimer = 0x01,
+  NackReason = 0x02,
+  AckOverflow = 0x03
+};
+
+enum Pid : uint16_t {
+  DiscUniqueBranch = 0x0001,
+  DiscMute = 0x0002,
+  DiscUnMute = 0x0003,
+  DeviceInfo = 0x0060,
+  DmxStartAddress = 0x00F0,
+  IdentifyDevice = 0x1000
+};
+
+struct Uid {
+  uint16_t manufacturer {0};
+  uint32_t device {0};
+
+  constexpr uint64_t value() const {
+    return (static_cast<uint64_t>(manufacturer) << 32) | device;
+  }
+  static constexpr Uid fromValue(uint64_t v) {
+    return Uid{static_cast<uint16_t>(v >> 32), static_cast<uint32_t>(v)};
+  }
+  constexpr bool operator==(const Uid &o) const { return value() == o.value(); }
+};
+
+constexpr Uid kBroadcast {0xFFFF, 0xFFFFFFFF};
+constexpr uint64_t kMaxUid = 0xFFFFFFFFFFFEULL;
+
+struct Message {
+  Uid destination;
+  Uid source;
+  uint8_t transaction {0};
+  uint8_t portOrResponse {1};      // requests: port ID; responses: ResponseType
+  uint8_t messageCount {0};
+  uint16_t subDevice {0};
+  uint8_t commandClass {Get};
+  uint16_t pid {0};
+  const uint8_t *data {nullptr};
+  uint8_t dataLength {0};
+};
+
+// Returns the packet length, or 0 if the data is too long or `out` is short.
+size_t encode(uint8_t *out, size_t capacity, const Message &msg);
+
+// Validates framing, length and checksum; leading null bytes (the UART's
+// view of the response break) are skipped. `msg.data` points into `data`.
+bool decode(const uint8_t *data, size_t len, Message &msg);
+
+// DISC_UNIQUE_BRANCH response: no break, no header, the UID bit-encoded so
+// that colliding responders show up as a checksum failure.
+size_t encodeDiscoveryResponse(uint8_t *out, size_t capacity, const Uid &uid);
+bool decodeDiscoveryResponse(const uint8_t *data, size_t len, Uid &uid);
+
+// Request builders for the controller.
+size_t discUniqueBranch(uint8_t *out, size_t capacity, const Uid &source, uint8_t transaction,
+                        uint64_t lower, uint64_t upper);
+size_t discMute(uint8_t *out, size_t capacity, const Uid &source, const Uid &destination,
+                uint8_t transaction, bool mute);
+size_t get(uint8_t *out, size_t capacity, const Uid &source, const Uid &destination,
+           uint8_t transaction, uint16_t pid);
+size_t set(uint8_t *out, size_t capacity, const Uid &source, const Uid &destination,
+           uint8_t transaction, uint16_t pid, const uint8_t *data, uint8_t dataLength);
+
+struct DeviceInfoData {
+  uint16_t protocolVersion {0};
+  uint16_t model {0};
+  uint16_t category {0};
+  uint32_t softwareVersion {0};
+  uint16_t footprint {0};
+  uint8_t personality {0};
+  uint8_t personalityCount {0};
+  uint16_t startAddress {0};  // 0xFFFF = no footprint
+  uint16_t subDevices {0};
+  uint8_t sensors {0};
+};
+
+// Parses the 19-byte DEVICE_INFO parameter data.
+bool parseDeviceInfo(const uint8_t *data, size_t len, DeviceInfoData &out);
+
+} // namespace RDM
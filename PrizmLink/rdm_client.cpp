@@ -0,0 +1,125 @@
+#include <utility>
+#include "rdm_client.h"
+
+namespace RDMClient {
+
+static int transact(Session &s, uint8_t port, size_t length, size_t capacity, bool discovery) {
+  return s.transport(port, s.request, length, s.response, capacity, discovery);
+}
+
+// Sends the request already in s.request and checks that the reply answers
+// it: right responder, command class, PID, transaction and an ACK.
+static bool exchange(Session &s, uint8_t port, size_t length, uint8_t transaction,
+                     const RDM::Uid &device, uint8_t commandClass, uint16_t pid,
+                     RDM::Message &reply) {
+  if (length == 0) return false;
+  for (uint8_t attempt = 0; attempt < kRetries; ++attempt) {
+    int n = transact(s, port, length, sizeof(s.response), false);
+    if (n <= 0) continue;
+    if (!RDM::decode(s.response, n, reply)) continue;
+    if (!(reply.source == device) || !(reply.destination == s.uid)) continue;
+    if (reply.commandClass != commandClass + 1 || reply.pid != pid) continue;
+    if (reply.transaction != transaction) continue;
+    return reply.portOrResponse == RDM::Ack;
+  }
+  return false;
+}
+
+static bool get(Session &s, uint8_t port, const RDM::Uid &device, uint16_t pid,
+                RDM::Message &reply) {
+  uint8_t transaction = s.transaction++;
+  size_t length = RDM::get(s.request, sizeof(s.request), s.uid, device, transaction, pid);
+  return exchange(s, port, length, transaction, device, RDM::Get, pid, reply);
+}
+
+static bool set(Session &s, uint8_t port, const RDM::Uid &device, uint16_t pid,
+                const uint8_t *data, uint8_t dataLength) {
+  RDM::Message reply;
+  uint8_t transaction = s.transaction++;
+  size_t length =
+      RDM::set(s.request, sizeof(s.request), s.uid, device, transaction, pid, data, dataLength);
+  return exchange(s, port, length, transaction, device, RDM::Set, pid, reply);
+}
+
+static bool mute(Session &s, uint8_t port, const RDM::Uid &device) {
+  RDM::Message reply;
+  uint8_t transaction = s.transaction++;
+  size_t length = RDM::discMute(s.request, sizeof(s.request), s.uid, device, transaction, true);
+  return exchange(s, port, length, transaction, device, RDM::Discovery, RDM::DiscMute, reply);
+}
+
+static void unmuteAll(Session &s, uint8_t port) {
+  size_t length =
+      RDM::discMute(s.request, sizeof(s.request), s.uid, RDM::kBroadcast, s.transaction++, false);
+  transact(s, port, length, 0, false);  // broadcasts get no reply
+}
+
+// A clean DISC_UNIQUE_BRANCH reply is a single responder, which is muted so
+// the range can be asked again; a garbled reply is a collision and the range
+// is split.
+bool discover(Session &s, uint8_t port, std::vector<RDM::Uid> &found, size_t limit) {
+  unmuteAll(s, port);
+  unmuteAll(s, port);
+
+  std::vector<std::pair<uint64_t, uint64_t>> ranges {{0, RDM::kMaxUid}};
+  uint16_t requests = 0;
+  uint8_t muteFailures = 0;
+
+  while (!ranges.empty() && found.size() < limit && requests++ < kMaxBranchRequests) {
+    auto [lower, upper] = ranges.back();
+    size_t length = RDM::discUniqueBranch(s.request, sizeof(s.request), s.uid, s.transaction++,
+                                          lower, upper);
+    int n = transact(s, port, length, RDM::kDiscoveryResponseLength, true);
+    if (n < 0) return false;
+    if (n == 0) {
+      ranges.pop_back();
+      continue;
+    }
+
+    RDM::Uid uid;
+    if (RDM::decodeDiscoveryResponse(s.response, n, uid) && uid.value() >= lower &&
+        uid.value() <= upper) {
+      if (mute(s, port, uid)) {
+        found.push_back(uid);
+        muteFailures = 0;
+      } else if (++muteFailures >= kRetries) {
+        ranges.pop_back();  // answers the branch but never the mute, give up on it
+        muteFailures = 0;
+      }
+      continue;
+    }
+
+    ranges.pop_back();
+    if (lower == upper) continue;
+    uint64_t mid = lower + (upper - lower) / 2;
+    ranges.push_back({mid + 1, upper});
+    ranges.push_back({lower, mid});
+  }
+  return true;
+}
+
+bool getDeviceInfo(Session &s, uint8_t port, const RDM::Uid &device, RDM::DeviceInfoData &info) {
+  RDM::Message reply;
+  return get(s, port, device, RDM::DeviceInfo, reply) &&
+         RDM::parseDeviceInfo(reply.data, reply.dataLength, info);
+}
+
+bool getStartAddress(Session &s, uint8_t port, const RDM::Uid &device, uint16_t &address) {
+  RDM::Message reply;
+  if (!get(s, port, device, RDM::DmxStartAddress, reply) || reply.dataLength != 2) return false;
+  address = (static_cast<uint16_t>(reply.data[0]) << 8) | reply.data[1];
+  return true;
+}
+
+bool setStartAddress(Session &s, uint8_t port, const RDM::Uid &device, uint16_t address) {
+  if (address < 1 || address > 512) return false;
+  uint8_t data[2] = {static_cast<uint8_t>(address >> 8), static_cast<uint8_t>(address)};
+  return set(s, port, device, RDM::DmxStartAddress, data, sizeof(data));
+}
+
+bool identify(Session &s, uint8_t port, const RDM::Uid &device, bool on) {
+  uint8_t data = on ? 1 : 0;
+  return set(s, port, device, RDM::IdentifyDevice, &data, 1);
+}
+
+} // namespace RDMClient
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "rdm.h"
+
+// RDM controller requests over an abstract transport, with no Arduino
+// dependency: discovery, DEVICE_INFO, DMX_START_ADDRESS and IDENTIFY_DEVICE.
+// Replies are matched to their request (responder, command class, PID and
+// transaction) and retried. RDMController runs these on the DMX ports; the
+// host tests run them against a loopback responder.
+namespace RDMClient {
+
+// Sends `length` bytes of `request` on `port` and reads the reply into
+// `response` (`capacity` 0 for broadcasts). Returns the bytes received, 0
+// when nothing answered, or -1 when the port cannot run an exchange.
+typedef int (*Transport)(uint8_t port, const uint8_t *request, size_t length, uint8_t *response,
+                         size_t capacity, bool discovery);
+
+struct Session {
+  RDM::Uid uid;                   // this controller
+  Transport transport {nullptr};
+  uint8_t transaction {0};
+  uint8_t request[RDM::kMaxMessageLength];
+  uint8_t response[RDM::kMaxMessageLength];
+};
+
+constexpr uint8_t kRetries = 2;
+constexpr uint16_t kMaxBranchRequests = 2048;
+
+// E1.20 binary search over the whole UID space. Appends the responders it
+// finds (and mutes) to `found`, stopping at `limit` entries. False when the
+// transport has no gap for discovery.
+bool discover(Session &session, uint8_t port, std::vector<RDM::Uid> &found, size_t limit);
+
+bool getDeviceInfo(Session &session, uint8_t port, const RDM::Uid &device,
+                   RDM::DeviceInfoData &info);
+bool getStartAddress(Session &session, uint8_t port, const RDM::Uid &device, uint16_t &address);
+bool setStartAddress(Session &session, uint8_t port, const RDM::Uid &device, uint16_t address);
+bool identify(Session &session, uint8_t port, const RDM::Uid &device, bool on);
+
+} // namespace RDMClient
@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <WiFi.h>
+#include "rdm_controller.h"
+#include "rdm_client.h"
+#include "debug_utils.h"
+#include "dmx_output.h"
+
+namespace RDMController {
+
+enum class CommandType : uint8_t { Discover, Identify, SetAddress };
+
+struct Command {
+  CommandType type {CommandType::Discover};
+  RDM::Uid uid;
+  uint16_t value {0};
+};
+
+static RDMClient::Session sSession;  // controller task only
+static uint8_t sPortCount = 0;
+static bool sReady = false;
+static std::atomic<bool> sBusy {false};
+
+static QueueHandle_t sCommands = nullptr;
+static TaskHandle_t sTask = nullptr;
+static SemaphoreHandle_t sDevicesMutex = nullptr;
+static std::vector<Device> sDevices;
+
+constexpr uint16_t kPrototypeManufacturer = 0x7FF0;  // ESTA prototyping range
+constexpr uint32_t kTransactionTimeoutMs = 100;
+constexpr size_t kMaxDevices = 64;
+constexpr BaseType_t kTaskCore = 1;
+constexpr UBaseType_t kTaskPriority = 1;
+constexpr uint32_t kTaskStack = 4096;
+constexpr int kCommandQueueDepth = 8;
+
+static int transport(uint8_t port, const uint8_t *request, size_t length, uint8_t *response,
+                     size_t capacity, bool discovery) {
+  return DMXOutput::rdmTransaction(port, request, length, response, capacity, discovery,
+                                   kTransactionTimeoutMs);
+}
+
+static size_t discoverPort(uint8_t port, std::vector<Device> &found) {
+  std::vector<RDM::Uid> uids;
+  if (!RDMClient::discover(sSession, port, uids, kMaxDevices - found.size())) {
+    Debug::warn("RDM", "Port %u: no gap for discovery", port);
+  }
+  for (const RDM::Uid &uid : uids) {
+    Device device;
+    device.uid = uid;
+    device.port = port;
+    device.infoValid = RDMClient::getDeviceInfo(sSession, port, uid, device.info);
+    found.push_back(device);
+  }
+  return uids.size();
+}
+
+static void runDiscovery() {
+  std::vector<Device> found;
+  for (uint8_t port = 0; port < sPortCount; ++port) {
+    if (!DMXOutput::rdmEnabled(port)) continue;
+    size_t count = discoverPort(port, found);
+    Debug::info("RDM", "Port %u: %u device(s)", port, static_cast<unsigned>(count));
+  }
+
+  xSemaphoreTake(sDevicesMutex, portMAX_DELAY);
+  sDevices.swap(found);
+  xSemaphoreGive(sDevicesMutex);
+}
+
+static bool findDevice(const RDM::Uid &uid, Device &out) {
+  bool found = false;
+  xSemaphoreTake(sDevicesMutex, portMAX_DELAY);
+  for (const auto &device : sDevices) {
+    if (device.uid == uid) {
+      out = device;
+      found = true;
+      break;
+    }
+  }
+  xSemaphoreGive(sDevicesMutex);
+  return found;
+}
+
+static void runSet(const Command &cmd) {
+  Device device;
+  if (!findDevice(cmd.uid, device)) return;
+
+  bool ok = cmd.type == CommandType::Identify
+                ? RDMClient::identify(sSession, device.port, cmd.uid, cmd.value != 0)
+                : RDMClient::setStartAddress(sSession, device.port, cmd.uid, cmd.value);
+  if (!ok) {
+    Debug::warn("RDM", "SET 0x%04x to %s failed",
+                cmd.type == CommandType::Identify ? RDM::IdentifyDevice : RDM::DmxStartAddress,
+                uidToString(cmd.uid).c_str());
+    return;
+  }
+
+  if (cmd.type == CommandType::SetAddress) {
+    // Keep what the device reports; it may clamp the address to its footprint.
+    uint16_t address = cmd.value;
+    RDMClient::getStartAddress(sSession, device.port, cmd.uid, address);
+    xSemaphoreTake(sDevicesMutex, portMAX_DELAY);
+    for (auto &d : sDevices) {
+      if (d.uid == cmd.uid) d.info.startAddress = address;
+    }
+    xSemaphoreGive(sDevicesMutex);
+  }
+}
+
+static void controllerTask(void *) {
+  Command cmd;
+  for (;;) {
+    if (xQueueReceive(sCommands, &cmd, portMAX_DELAY) != pdTRUE) continue;
+    sBusy = true;
+    if (cmd.type == CommandType::Discover) {
+      runDiscovery();
+    } else {
+      runSet(cmd);
+    }
+    sBusy = uxQueueMessagesWaiting(sCommands) > 0;
+  }
+}
+
+static bool post(const Command &cmd) {
+  if (!sReady) return false;
+  return xQueueSend(sCommands, &cmd, 0) == pdTRUE;
+}
+
+bool begin(const Prizm::DMXConfig &cfg) {
+  sReady = false;
+  sPortCount = std::min(cfg.portCount, Prizm::kMaxDMXPorts);
+  bool any = false;
+  for (uint8_t port = 0; port < sPortCount; ++port) any |= DMXOutput::rdmEnabled(port);
+  if (!any) return false;
+
+  uint8_t mac[6];
+  WiFi.macAddress(mac);
+  sSession.uid.manufacturer = kPrototypeManufacturer;
+  sSession.uid.device = (static_cast<uint32_t>(mac[2]) << 24) | (static_cast<uint32_t>(mac[3]) << 16) |
+                (static_cast<uint32_t>(mac[4]) << 8) | mac[5];
+
+  if (!sDevicesMutex) sDevicesMutex = xSemaphoreCreateMutex();
+  if (!sCommands) sCommands = xQueueCreate(kCommandQueueDepth, sizeof(Command));
+  if (!sDevicesMutex || !sCommands) {
+    Debug::error("RDM", "Allocation failed");
+    return false;
+  }
+
+  if (!sTask &&
+      xTaskCreatePinnedToCore(controllerTask, "rdm", kTaskStack, nullptr, kTaskPriority, &sTask,
+                              kTaskCore) != pdPASS) {
+    sTask = nullptr;
+    Debug::error("RDM", "Task failed to start");
+    return false;
+  }
+
+  sSession.transport = transport;
+  sReady = true;
+  Debug::info("RDM", "Controller %s", uidToString(sSession.uid).c_str());
+  discover();
+  return true;
+}
+
+void discover() {
+  Command cmd;
+  cmd.type = CommandType::Discover;
+  if (post(cmd)) sBusy = true;
+}
+
+bool identify(const RDM::Uid &uid, bool on) {
+  Command cmd;
+  cmd.type = CommandType::Identify;
+  cmd.uid = uid;
+  cmd.value = on ? 1 : 0;
+  return post(cmd);
+}
+
+bool setStartAddress(const RDM::Uid &uid, uint16_t address) {
+  if (address < 1 || address > 512) return false;
+  Command cmd;
+  cmd.type = CommandType::SetAddress;
+  cmd.uid = uid;
+  cmd.value = address;
+  return post(cmd);
+}
+
+bool isReady() {
+  return sReady;
+}
+
+bool busy() {
+  return sBusy;
+}
+
+RDM::Uid controllerUid() {
+  return sSession.uid;
+}
+
+std::vector<Device> devices() {
+  std::vector<Device> copy;
+  if (!sDevicesMutex) return copy;
+  xSemaphoreTake(sDevicesMutex, portMAX_DELAY);
+  copy = sDevices;
+  xSemaphoreGive(sDevicesMutex);
+  return copy;
+}
+
+String uidToString(const RDM::Uid &uid) {
+  char text[16];
+  snprintf(text, sizeof(text), "%04x:%08lx", uid.manufacturer,
+           static_cast<unsigned long>(uid.device));
+  return String(text);
+}
+
+bool parseUid(const char *text, RDM::Uid &uid) {
+  if (!text) return false;
+  unsigned manufacturer = 0;
+  unsigned long device = 0;
+  char tail = 0;
+  if (sscanf(text, "%4x:%8lx%c", &manufacturer, &device, &tail) != 2) return false;
+  uid.manufacturer = static_cast<uint16_t>(manufacturer);
+  uid.device = static_cast<uint32_t>(device);
+  return true;
+}
+
+} // namespace RDMController
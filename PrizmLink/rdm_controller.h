@@ -0,0 +1,36 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+#include "config.h"
+#include "rdm.h"
+
+namespace RDMController {
+
+struct Device {
+  RDM::Uid uid;
+  uint8_t port {0};
+  bool infoValid {false};
+  RDM::DeviceInfoData info;
+};
+
+// Runs RDM discovery and device requests on every DMX port with `rdm` set.
+// Requests go through DMXOutput::rdmTransaction(), so they only use the gap
+// after each refresh. All calls below are non-blocking; work is queued to a
+// background task.
+bool begin(const Prizm::DMXConfig &cfg);
+
+void discover();
+bool identify(const RDM::Uid &uid, bool on);
+bool setStartAddress(const RDM::Uid &uid, uint16_t address);
+
+bool isReady();
+bool busy();
+RDM::Uid controllerUid();
+std::vector<Device> devices();
+
+// "mmmm:dddddddd", as E1.20 prints UIDs.
+String uidToString(const RDM::Uid &uid);
+bool parseUid(const char *text, RDM::Uid &uid);
+
+} // namespace RDMController
@@ -0,0 +1,90 @@
+// Receive-path throughput: parse each datagram, range-check its universe
+// and copy the levels into that universe's window of a frame buffer, the
+// way NetworkE131 handles a single-source stream.
+//
+//   bench_e131_packet [--max-ns N] [--packets N]
+//
+// Exits non-zero when any stream costs more than N ns per packet.
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "e131_packet.h"
+
+using namespace E131Packet;
+
+constexpr uint16_t kBaseUniverse = 1;
+constexpr size_t kChannels = 512;
+
+struct Result {
+  double packetsPerSecond;
+  double nsPerPacket;
+  uint32_t checksum;
+};
+
+static Result run(uint16_t universes, size_t packets) {
+  uint8_t cid[16];
+  for (int i = 0; i < 16; ++i) cid[i] = static_cast<uint8_t>(i * 11);
+  Source source{cid, "bench", 100};
+
+  // 256 sequence numbers per universe, so every packet is distinct.
+  std::vector<std::array<uint8_t, kMaxDataPacketLength>> stream(universes * 256u);
+  std::vector<size_t> lengths(stream.size());
+  uint8_t levels[kChannels];
+  for (size_t i = 0; i < stream.size(); ++i) {
+    uint16_t universe = kBaseUniverse + i % universes;
+    uint8_t sequence = static_cast<uint8_t>(i / universes);
+    for (size_t c = 0; c < kChannels; ++c) levels[c] = static_cast<uint8_t>(c + i);
+    lengths[i] = buildData(stream[i].data(), stream[i].size(), source, universe, sequence, levels,
+                           kChannels);
+  }
+
+  std::vector<uint8_t> frame(static_cast<size_t>(universes) * kChannels);
+  std::array<uint8_t, 64000> lastSequence {};
+  uint32_t rejected = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t n = 0; n < packets; ++n) {
+    size_t i = n % stream.size();
+    View view = parse(stream[i].data(), lengths[i]);
+    if (view.kind != Kind::Data || view.universe < kBaseUniverse ||
+        view.universe >= kBaseUniverse + universes) {
+      rejected++;
+      continue;
+    }
+    int8_t delta = static_cast<int8_t>(view.sequence - lastSequence[view.universe]);
+    if (delta < 0 && delta > -20) rejected++;
+    lastSequence[view.universe] = view.sequence;
+    memcpy(frame.data() + static_cast<size_t>(view.universe - kBaseUniverse) * kChannels,
+           view.levels, view.length);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  double seconds = std::chrono::duration<double>(elapsed).count();
+  uint32_t checksum = rejected;
+  for (uint8_t b : frame) checksum = checksum * 31 + b;
+  return {packets / seconds, seconds * 1e9 / packets, checksum};
+}
+
+int main(int argc, char **argv) {
+  double maxNs = 0;
+  size_t packets = 2000000;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (!strcmp(argv[i], "--max-ns")) maxNs = atof(argv[i + 1]);
+    if (!strcmp(argv[i], "--packets")) packets = strtoul(argv[i + 1], nullptr, 10);
+  }
+
+  bool ok = true;
+  for (uint16_t universes : {1, 4, 12}) {
+    Result r = run(universes, packets);
+    std::printf("%2u universe%s: %10.0f packets/s  %7.1f ns/packet  (checksum %08x)\n", universes,
+                universes == 1 ? " " : "s", r.packetsPerSecond, r.nsPerPacket, r.checksum);
+    if (maxNs > 0 && r.nsPerPacket > maxNs) {
+      std::printf("  over budget: %.1f ns > %.1f ns\n", r.nsPerPacket, maxNs);
+      ok = false;
+    }
+  }
+  return ok ? 0 : 1;
+}
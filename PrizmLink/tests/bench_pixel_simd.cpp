@@ -0,0 +1,87 @@
+// Pixel kernel throughput on a 2000-pixel RGB (or RGBW) frame, each kernel
+// next to the per-byte loop it replaces. The references are inlined here
+// with a known frame size, which flatters them slightly.
+//
+//   bench_pixel_simd [--min-rate N] [--frames N]
+//
+// Exits non-zero when any kernel moves fewer than N pixels per µs.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+#include "pixel_simd.h"
+#include "pixel_simd_ref.h"
+
+constexpr size_t kPixels = 2000;
+
+static uint32_t gSink = 0;  // keeps results observable
+
+static double rate(size_t frames, const std::function<uint32_t()> &frame) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t n = 0; n < frames; ++n) gSink += frame();
+  double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+                  .count();
+  return frames * kPixels / us;
+}
+
+int main(int argc, char **argv) {
+  double minRate = 0;
+  size_t frames = 20000;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (!strcmp(argv[i], "--min-rate")) minRate = atof(argv[i + 1]);
+    if (!strcmp(argv[i], "--frames")) frames = strtoul(argv[i + 1], nullptr, 10);
+  }
+
+  std::vector<uint8_t> src(kPixels * 4), dst(kPixels * 4), residue(kPixels * 3);
+  std::vector<uint16_t> levels(kPixels * 3);
+  for (size_t i = 0; i < src.size(); ++i) src[i] = static_cast<uint8_t>(i * 37 + 11);
+  for (size_t i = 0; i < levels.size(); ++i) levels[i] = static_cast<uint16_t>(i * 4099);
+  for (size_t i = 0; i < residue.size(); ++i) residue[i] = static_cast<uint8_t>(i * 16);
+  const uint8_t grb[3] = {1, 0, 2};
+  const size_t rgb = kPixels * 3;
+
+  struct Row {
+    const char *name;
+    std::function<uint32_t()> kernel, reference;
+  };
+  const Row rows[] = {
+      {"shuffle3 GRB",
+       [&] { return PixelSIMD::shuffle3(dst.data(), src.data(), kPixels, grb); },
+       [&] { return refShuffle(dst.data(), src.data(), kPixels, grb, 3); }},
+      {"shuffle4 GRBW",
+       [&] { return PixelSIMD::shuffle4(dst.data(), src.data(), kPixels, grb); },
+       [&] { return refShuffle(dst.data(), src.data(), kPixels, grb, 4); }},
+      {"sum8",
+       [&] { return PixelSIMD::sum8(src.data(), rgb); },
+       [&] { return refSum8(src.data(), rgb); }},
+      {"scale8",
+       [&] { memcpy(dst.data(), src.data(), rgb); PixelSIMD::scale8(dst.data(), rgb, 200); return dst[7]; },
+       [&] { memcpy(dst.data(), src.data(), rgb); refScale8(dst.data(), rgb, 200); return dst[7]; }},
+      {"scaleCopy8",
+       [&] { return static_cast<uint32_t>(PixelSIMD::scaleCopy8(dst.data(), src.data(), rgb, 200 + (dst[0] & 1))); },
+       [&] { return static_cast<uint32_t>(refScaleCopy8(dst.data(), src.data(), rgb, 200 + (dst[0] & 1))); }},
+      {"dither16",
+       [&] { PixelSIMD::dither16(dst.data(), levels.data(), residue.data(), rgb); return dst[7]; },
+       [&] { refDither16(dst.data(), levels.data(), residue.data(), rgb); return dst[7]; }},
+      {"round16",
+       [&] { PixelSIMD::round16(dst.data(), levels.data(), rgb); return dst[7]; },
+       [&] { refRound16(dst.data(), levels.data(), rgb); return dst[7]; }},
+  };
+
+  bool ok = true;
+  std::printf("%-14s %12s %12s  (pixels/us, %zu-pixel frame)\n", "kernel", "kernel", "per-byte",
+              kPixels);
+  for (const Row &row : rows) {
+    double kernel = rate(frames, row.kernel);
+    double reference = rate(frames, row.reference);
+    std::printf("%-14s %12.1f %12.1f  x%.2f\n", row.name, kernel, reference, kernel / reference);
+    if (minRate > 0 && kernel < minRate) {
+      std::printf("  under budget: %.1f < %.1f pixels/us\n", kernel, minRate);
+      ok = false;
+    }
+  }
+  std::printf("(sink %08x)\n", gSink);
+  return ok ? 0 : 1;
+}
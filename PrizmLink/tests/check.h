@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal assertion helpers for the host tests; a test binary returns the
+// failure count from main().
+static int gFailures = 0;
+
+#define CHECK(cond)                                                        \
+  do {                                                                     \
+    if (!(cond)) {                                                         \
+      std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      ++gFailures;                                                         \
+    }                                                                      \
+  } while (0)
+
+#define CHECK_EQ(a, b) CHECK((a) == (b))
+
+inline int finish(const char *name) {
+  std::printf("%s: %s (%d failure%s)\n", name, gFailures ? "FAIL" : "ok", gFailures,
+              gFailures == 1 ? "" : "s");
+  return gFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// The per-byte loops the PixelSIMD kernels replace, kept as references for
+// the equivalence test and as the baseline in the benchmark.
+
+inline uint32_t refSum8(const uint8_t *data, size_t len) {
+  uint32_t sum = 0;
+  for (size_t i = 0; i < len; ++i) sum += data[i];
+  return sum;
+}
+
+inline void refScale8(uint8_t *data, size_t len, uint16_t factor) {
+  if (factor >= 256) return;
+  for (size_t i = 0; i < len; ++i) data[i] = (data[i] * factor) >> 8;
+}
+
+inline bool refScaleCopy8(uint8_t *dst, const uint8_t *src, size_t len, uint16_t factor) {
+  bool changed = false;
+  for (size_t i = 0; i < len; ++i) {
+    uint8_t level = factor >= 256 ? src[i] : (src[i] * factor) >> 8;
+    changed |= dst[i] != level;
+    dst[i] = level;
+  }
+  return changed;
+}
+
+inline uint32_t refShuffle(uint8_t *dst, const uint8_t *src, size_t pixels, const uint8_t *order,
+                           uint8_t channels) {
+  uint32_t sum = 0;
+  for (size_t i = 0; i < pixels; ++i, src += channels, dst += channels) {
+    for (uint8_t k = 0; k < channels; ++k) {
+      dst[k] = src[k < 3 ? order[k] : k];
+      sum += dst[k];
+    }
+  }
+  return sum;
+}
+
+inline void refDither16(uint8_t *dst, const uint16_t *src, uint8_t *residue, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t sum = static_cast<uint32_t>(src[i]) + residue[i];
+    if (sum > 0xFFFF) {
+      dst[i] = 255;
+      continue;
+    }
+    dst[i] = sum >> 8;
+    residue[i] = sum & 0xFF;
+  }
+}
+
+inline void refRound16(uint8_t *dst, const uint16_t *src, size_t count) {
+  for (size_t i = 0; i < count; ++i) dst[i] = std::min<uint32_t>((src[i] + 0x80U) >> 8, 255);
+}
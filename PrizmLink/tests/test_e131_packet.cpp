@@ -0,0 +1,200 @@
+#include <cstring>
+#include <vector>
+#include "check.h"
+#include "e131_packet.h"
+
+using namespace E131Packet;
+
+// Reference datagrams written out byte for byte in E1.31-2018 wire order,
+// as a sender such as sACNView puts them on the network.
+static const uint8_t kDataPacket[] = {
+    // Root layer
+    0x00, 0x10, 0x00, 0x00, 0x41, 0x53, 0x43, 0x2d, 0x45, 0x31, 0x2e, 0x31, 0x37, 0x00, 0x00, 0x00,
+    0x70, 0x76, 0x00, 0x00, 0x00, 0x04,
+    0x5a, 0x1c, 0x0f, 0x8e, 0x32, 0x6b, 0x4d, 0x05, 0x9f, 0x7c, 0x01, 0xd2, 0x44, 0x6e, 0x3a, 0xb1,
+    // Framing layer: source name "sACNView", priority 100, sequence 42, universe 1
+    0x70, 0x60, 0x00, 0x00, 0x00, 0x02,
+    0x73, 0x41, 0x43, 0x4e, 0x56, 0x69, 0x65, 0x77, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x64, 0x00, 0x00, 0x2a, 0x00, 0x00, 0x01,
+    // DMP layer: 8 slots after a null start code
+    0x70, 0x13, 0x02, 0xa1, 0x00, 0x00, 0x00, 0x01, 0x00, 0x09, 0x00,
+    0xff, 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x00,
+};
+
+static const uint8_t kSyncPacket[] = {
+    0x00, 0x10, 0x00, 0x00, 0x41, 0x53, 0x43, 0x2d, 0x45, 0x31, 0x2e, 0x31, 0x37, 0x00, 0x00, 0x00,
+    0x70, 0x21, 0x00, 0x00, 0x00, 0x08,
+    0x5a, 0x1c, 0x0f, 0x8e, 0x32, 0x6b, 0x4d, 0x05, 0x9f, 0x7c, 0x01, 0xd2, 0x44, 0x6e, 0x3a, 0xb1,
+    0x70, 0x0b, 0x00, 0x00, 0x00, 0x01, 0x07, 0x00, 0x07, 0x00, 0x00,
+};
+
+static std::vector<uint8_t> dataPacket() {
+  return std::vector<uint8_t>(kDataPacket, kDataPacket + sizeof(kDataPacket));
+}
+
+static void testReferenceData() {
+  View view = parse(kDataPacket, sizeof(kDataPacket));
+  CHECK(view.kind == Kind::Data);
+  CHECK_EQ(view.universe, 1);
+  CHECK_EQ(view.sequence, 42);
+  CHECK_EQ(view.priority, 100);
+  CHECK_EQ(view.syncAddress, 0);
+  CHECK_EQ(view.options, 0);
+  CHECK_EQ(view.length, 8);
+  CHECK(view.cid == kDataPacket + 22);
+  CHECK(view.levels == kDataPacket + 126);
+  CHECK_EQ(view.levels[0], 0xff);
+  CHECK_EQ(view.levels[7], 0x00);
+}
+
+static void testReferenceSync() {
+  View view = parse(kSyncPacket, sizeof(kSyncPacket));
+  CHECK(view.kind == Kind::Sync);
+  CHECK_EQ(view.syncAddress, 7);
+  CHECK(view.cid == kSyncPacket + 22);
+}
+
+static void testRoundTrip() {
+  uint8_t cid[16];
+  for (int i = 0; i < 16; ++i) cid[i] = static_cast<uint8_t>(0xA0 + i);
+  uint8_t levels[512];
+  for (int i = 0; i < 512; ++i) levels[i] = static_cast<uint8_t>(i * 7);
+  Source source{cid, "PrizmLink", 150};
+
+  for (uint16_t count : {1, 8, 170, 512}) {
+    uint8_t out[kMaxDataPacketLength];
+    size_t len = buildData(out, sizeof(out), source, 63999, 200, levels, count);
+    CHECK_EQ(len, kDataHeaderLength + count);
+    View view = parse(out, len);
+    CHECK(view.kind == Kind::Data);
+    CHECK_EQ(view.universe, 63999);
+    CHECK_EQ(view.sequence, 200);
+    CHECK_EQ(view.priority, 150);
+    CHECK_EQ(view.length, count);
+    CHECK(memcmp(view.cid, cid, 16) == 0);
+    CHECK(memcmp(view.levels, levels, count) == 0);
+    CHECK(strcmp(reinterpret_cast<const char*>(out + 44), "PrizmLink") == 0);
+  }
+
+  // The builder emits the same header bytes as the reference capture.
+  uint8_t out[kMaxDataPacketLength];
+  Source sacnView{kDataPacket + 22, "sACNView", 100};
+  size_t len = buildData(out, sizeof(out), sacnView, 1, 42, kDataPacket + 126, 8);
+  CHECK_EQ(len, sizeof(kDataPacket));
+  CHECK(memcmp(out, kDataPacket, sizeof(kDataPacket)) == 0);
+}
+
+static void testBuildRejects() {
+  uint8_t cid[16] = {};
+  uint8_t levels[513] = {};
+  uint8_t out[kMaxDataPacketLength + 1];
+  Source source{cid, "x", 100};
+  CHECK_EQ(buildData(out, sizeof(out), source, 1, 0, levels, 513), 0u);
+  CHECK_EQ(buildData(out, kDataHeaderLength + 9, source, 1, 0, levels, 10), 0u);
+  Source noCid{nullptr, "x", 100};
+  CHECK_EQ(buildData(out, sizeof(out), noCid, 1, 0, levels, 10), 0u);
+}
+
+static void expectInvalid(const std::vector<uint8_t> &packet, size_t len, const char *what) {
+  View view = parse(packet.data(), len);
+  if (view.kind != Kind::Invalid) std::printf("  accepted: %s\n", what);
+  CHECK(view.kind == Kind::Invalid);
+}
+
+static void testRejectsBadVectors() {
+  auto p = dataPacket();
+  p[21] = 0x05;  // root vector
+  expectInvalid(p, p.size(), "root vector");
+
+  p = dataPacket();
+  p[43] = 0x03;  // framing vector
+  expectInvalid(p, p.size(), "framing vector");
+
+  p = dataPacket();
+  p[117] = 0x01;  // DMP vector
+  expectInvalid(p, p.size(), "DMP vector");
+
+  p = dataPacket();
+  p[118] = 0xa2;  // address and data type
+  expectInvalid(p, p.size(), "DMP address type");
+
+  p = dataPacket();
+  p[6] = 'X';  // ACN packet identifier
+  expectInvalid(p, p.size(), "packet identifier");
+
+  p = dataPacket();
+  p[1] = 0x11;  // preamble size
+  expectInvalid(p, p.size(), "preamble");
+}
+
+static void testRejectsBadLengths() {
+  auto p = dataPacket();
+  expectInvalid(p, 0, "empty");
+  expectInvalid(p, 48, "shorter than any header");
+  expectInvalid(p, 125, "truncated DMP header");
+  expectInvalid(p, p.size() - 1, "truncated levels");
+
+  p = dataPacket();
+  p[17] = 0x77;  // root PDU claims one byte more than the datagram
+  expectInvalid(p, p.size(), "root PDU length");
+
+  p = dataPacket();
+  p[123] = 0x02;
+  p[124] = 0x02;  // 514 properties
+  expectInvalid(p, p.size(), "property count");
+
+  p = dataPacket();
+  p[124] = 0x01;  // start code only
+  expectInvalid(p, p.size(), "no slots");
+}
+
+static void testRejectsUniverses() {
+  auto p = dataPacket();
+  p[113] = 0x00;
+  p[114] = 0x00;
+  expectInvalid(p, p.size(), "universe 0");
+
+  p = dataPacket();
+  p[113] = 0xfa;
+  p[114] = 0x00;  // 64000
+  expectInvalid(p, p.size(), "universe 64000");
+
+  std::vector<uint8_t> sync(kSyncPacket, kSyncPacket + sizeof(kSyncPacket));
+  sync[45] = 0x00;
+  sync[46] = 0x00;
+  expectInvalid(sync, sync.size(), "sync address 0");
+  sync[45] = 0xff;
+  sync[46] = 0xff;
+  expectInvalid(sync, sync.size(), "sync address 65535");
+}
+
+static void testRejectsOptionsAndStartCode() {
+  auto p = dataPacket();
+  p[112] = kOptionPreviewData;
+  expectInvalid(p, p.size(), "preview data");
+
+  p = dataPacket();
+  p[125] = 0xcc;  // RDM start code
+  expectInvalid(p, p.size(), "non-zero start code");
+
+  p = dataPacket();
+  p[112] = kOptionStreamTerminated;
+  View view = parse(p.data(), p.size());
+  CHECK(view.kind == Kind::Data);
+  CHECK_EQ(view.options, kOptionStreamTerminated);
+}
+
+int main() {
+  testReferenceData();
+  testReferenceSync();
+  testRoundTrip();
+  testBuildRejects();
+  testRejectsBadVectors();
+  testRejectsBadLengths();
+  testRejectsUniverses();
+  testRejectsOptionsAndStartCode();
+  return finish("e131_packet");
+}
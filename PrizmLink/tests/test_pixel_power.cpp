@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <vector>
+#include "check.h"
+#include "pixel_power.h"
+#include "pixel_simd.h"
+
+using PixelPower::Budget;
+using PixelPower::Estimate;
+
+static void testLimit() {
+  Budget budget;
+  budget.maxMilliamps = 2000;
+  budget.milliampsPerChannel = 20;
+  budget.idleMilliamps = 200;
+
+  Estimate within = PixelPower::limit(budget, 255 * 50);  // 50 channels, 1000 mA
+  CHECK_EQ(within.factor, 256);
+  CHECK_EQ(within.milliamps, 1200u);
+
+  Estimate over = PixelPower::limit(budget, 255 * 300);  // 6000 mA of content
+  CHECK(over.factor < 256);
+  CHECK_EQ(over.factor, (1800u << 8) / 6000);
+  CHECK(over.milliamps <= budget.maxMilliamps);
+
+  Estimate starved = PixelPower::limit(Budget{100, 20, 200}, 255);  // idle alone is over
+  CHECK_EQ(starved.factor, 0);
+
+  budget.maxMilliamps = 0;  // unlimited still reports the draw
+  Estimate open = PixelPower::limit(budget, 255 * 300);
+  CHECK_EQ(open.factor, 256);
+  CHECK_EQ(open.milliamps, 6200u);
+}
+
+// PixelOutput's frame path in miniature: two strips in one render buffer,
+// only the first rewritten each frame, the second left as rendered once.
+// The estimate covers both and the limit only touches the wire copy, so a
+// constant frame held over many limited frames gives a constant output.
+static void testHeldFrameIsStable() {
+  constexpr size_t kStripBytes = 300;
+  Budget budget {1500, 20, 0};
+  std::vector<uint8_t> render(2 * kStripBytes), wire(render.size());
+  std::vector<uint8_t> content(kStripBytes);
+  for (size_t i = 0; i < kStripBytes; ++i) content[i] = static_cast<uint8_t>(200 + i % 56);
+  for (size_t i = 0; i < kStripBytes; ++i) render[kStripBytes + i] = static_cast<uint8_t>(i * 7);
+  const std::vector<uint8_t> untouched(render.begin() + kStripBytes, render.end());
+  uint32_t secondSum = PixelSIMD::sum8(render.data() + kStripBytes, kStripBytes);
+
+  std::vector<uint8_t> firstWire;
+  uint16_t firstFactor = 0;
+  for (int frame = 0; frame < 100; ++frame) {
+    std::copy(content.begin(), content.end(), render.begin());
+    uint32_t levelSum = PixelSIMD::sum8(render.data(), kStripBytes) + secondSum;
+    Estimate estimate = PixelPower::limit(budget, levelSum);
+    CHECK(estimate.factor < 256);
+    bool changed = PixelSIMD::scaleCopy8(wire.data(), render.data(), wire.size(), estimate.factor);
+
+    if (frame == 0) {
+      firstWire = wire;
+      firstFactor = estimate.factor;
+      CHECK(changed);
+      continue;
+    }
+    CHECK_EQ(estimate.factor, firstFactor);
+    CHECK(!changed);
+    CHECK(wire == firstWire);
+  }
+  CHECK(std::equal(untouched.begin(), untouched.end(), render.begin() + kStripBytes));
+
+  uint32_t wireSum = PixelSIMD::sum8(wire.data(), wire.size());
+  CHECK(static_cast<uint64_t>(wireSum) * budget.milliampsPerChannel / 255 <= budget.maxMilliamps);
+}
+
+int main() {
+  testLimit();
+  testHeldFrameIsStable();
+  return finish("pixel_power");
+}
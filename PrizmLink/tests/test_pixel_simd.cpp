@@ -0,0 +1,145 @@
+#include <cstring>
+#include <random>
+#include <vector>
+#include "check.h"
+#include "pixel_simd.h"
+#include "pixel_simd_ref.h"
+
+// Each kernel against the per-byte loop it replaces, over random lengths,
+// buffer misalignments, orders and levels.
+
+static std::mt19937 gRandom(0x5EED);
+
+static const uint8_t kOrders[6][3] = {
+    {0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0},
+};
+
+static std::vector<uint8_t> randomBytes(size_t len) {
+  std::vector<uint8_t> bytes(len);
+  for (auto &b : bytes) b = static_cast<uint8_t>(gRandom());
+  return bytes;
+}
+
+// Levels biased towards the ends so saturation and zero are exercised.
+static uint16_t randomLevel() {
+  switch (gRandom() % 4) {
+    case 0: return static_cast<uint16_t>(0xFF00 + gRandom() % 256);
+    case 1: return static_cast<uint16_t>(gRandom() % 256);
+    default: return static_cast<uint16_t>(gRandom());
+  }
+}
+
+static void testSum8() {
+  for (int trial = 0; trial < 500; ++trial) {
+    size_t offset = gRandom() % 4;
+    size_t len = gRandom() % (trial < 10 ? 4000 : 300);
+    auto bytes = randomBytes(offset + len);
+    CHECK_EQ(PixelSIMD::sum8(bytes.data() + offset, len), refSum8(bytes.data() + offset, len));
+  }
+  std::vector<uint8_t> full(5000, 255);
+  CHECK_EQ(PixelSIMD::sum8(full.data(), full.size()), 255u * 5000);
+}
+
+static void testScale8() {
+  for (int trial = 0; trial < 500; ++trial) {
+    size_t offset = gRandom() % 4;
+    size_t len = gRandom() % 300;
+    uint16_t factor = gRandom() % 258;
+    auto bytes = randomBytes(offset + len);
+    auto expected = bytes;
+    PixelSIMD::scale8(bytes.data() + offset, len, factor);
+    refScale8(expected.data() + offset, len, factor);
+    CHECK(bytes == expected);
+  }
+}
+
+static void testScaleCopy8() {
+  for (int trial = 0; trial < 500; ++trial) {
+    size_t dstOffset = gRandom() % 4, srcOffset = trial % 2 ? dstOffset : gRandom() % 4;
+    size_t len = gRandom() % 300;
+    uint16_t factor = gRandom() % 258;
+    auto src = randomBytes(srcOffset + len);
+    auto dst = randomBytes(dstOffset + len);
+    auto expected = dst;
+    bool changed = PixelSIMD::scaleCopy8(dst.data() + dstOffset, src.data() + srcOffset, len, factor);
+    CHECK_EQ(changed, refScaleCopy8(expected.data() + dstOffset, src.data() + srcOffset, len, factor));
+    CHECK(dst == expected);
+    // A second copy of the same frame changes nothing.
+    CHECK(!PixelSIMD::scaleCopy8(dst.data() + dstOffset, src.data() + srcOffset, len, factor));
+  }
+}
+
+static void testShuffle(uint8_t channels) {
+  for (int trial = 0; trial < 600; ++trial) {
+    const uint8_t *order = kOrders[trial % 6];
+    size_t offset = gRandom() % 4;
+    size_t pixels = gRandom() % (trial < 12 ? 1000 : 100);
+    auto src = randomBytes(offset + pixels * channels);
+    std::vector<uint8_t> dst(offset + pixels * channels + 4, 0xAA);
+    auto expected = dst;
+    uint32_t sum = channels == 3
+                       ? PixelSIMD::shuffle3(dst.data() + offset, src.data() + offset, pixels, order)
+                       : PixelSIMD::shuffle4(dst.data() + offset, src.data() + offset, pixels, order);
+    CHECK_EQ(sum, refShuffle(expected.data() + offset, src.data() + offset, pixels, order, channels));
+    CHECK(dst == expected);  // including the guard bytes past the end
+  }
+}
+
+static void testDither16() {
+  for (int trial = 0; trial < 300; ++trial) {
+    size_t count = gRandom() % 300;
+    std::vector<uint16_t> levels(count);
+    for (auto &level : levels) level = randomLevel();
+    auto residue = randomBytes(count);
+    auto expectedResidue = residue;
+    std::vector<uint8_t> dst(count), expected(count);
+    for (int frame = 0; frame < 4; ++frame) {
+      PixelSIMD::dither16(dst.data(), levels.data(), residue.data(), count);
+      refDither16(expected.data(), levels.data(), expectedResidue.data(), count);
+      CHECK(dst == expected);
+      CHECK(residue == expectedResidue);
+    }
+  }
+
+  // A level's frames average to it: 0x1280 alternates 0x12 and 0x13.
+  uint16_t level = 0x1280;
+  uint8_t residue = 0, out = 0;
+  uint32_t total = 0;
+  for (int frame = 0; frame < 256; ++frame) {
+    PixelSIMD::dither16(&out, &level, &residue, 1);
+    total += out;
+  }
+  CHECK_EQ(total, 0x1280u);
+}
+
+static void testRound16() {
+  for (int trial = 0; trial < 300; ++trial) {
+    size_t count = gRandom() % 300;
+    std::vector<uint16_t> levels(count);
+    for (auto &level : levels) level = randomLevel();
+    std::vector<uint8_t> dst(count), expected(count);
+    PixelSIMD::round16(dst.data(), levels.data(), count);
+    refRound16(expected.data(), levels.data(), count);
+    CHECK(dst == expected);
+  }
+  uint16_t edges[] = {0, 0x7F, 0x80, 0xFE7F, 0xFE80, 0xFFFF};
+  uint8_t out[6];
+  PixelSIMD::round16(out, edges, 6);
+  CHECK_EQ(out[0], 0);
+  CHECK_EQ(out[1], 0);
+  CHECK_EQ(out[2], 1);
+  CHECK_EQ(out[3], 254);
+  CHECK_EQ(out[4], 255);
+  CHECK_EQ(out[5], 255);
+}
+
+int main() {
+  testSum8();
+  testScale8();
+  testScaleCopy8();
+  testShuffle(3);
+  testShuffle(4);
+  testDither16();
+  testRound16();
+  return finish("pixel_simd");
+}
@@ -0,0 +1,288 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "check.h"
+#include "rdm.h"
+#include "rdm_client.h"
+
+using namespace RDM;
+
+// Codec checks, then RDMClient driving loopback responders the way
+// RDMController drives fixtures on a DMX port.
+
+static const Uid kController {0x7FF0, 0x00C0FFEE};
+
+static void testRoundTrip() {
+  uint8_t data[5] = {1, 2, 3, 4, 5};
+  Message msg;
+  msg.destination = Uid{0x1234, 0x56789ABC};
+  msg.source = kController;
+  msg.transaction = 77;
+  msg.portOrResponse = 1;
+  msg.subDevice = 3;
+  msg.commandClass = Set;
+  msg.pid = DmxStartAddress;
+  msg.data = data;
+  msg.dataLength = sizeof(data);
+
+  uint8_t out[kMaxMessageLength + 2] = {};
+  size_t len = encode(out + 2, sizeof(out) - 2, msg);  // two leading nulls, as the UART sees a break
+  CHECK_EQ(len, kHeaderLength + sizeof(data) + 2);
+  CHECK_EQ(out[2], kStartCode);
+  CHECK_EQ(out[4], kHeaderLength + sizeof(data));
+
+  Message back;
+  CHECK(decode(out, len + 2, back));
+  CHECK(back.destination == msg.destination);
+  CHECK(back.source == msg.source);
+  CHECK_EQ(back.transaction, 77);
+  CHECK_EQ(back.subDevice, 3);
+  CHECK_EQ(back.commandClass, Set);
+  CHECK_EQ(back.pid, DmxStartAddress);
+  CHECK_EQ(back.dataLength, sizeof(data));
+  CHECK(back.data && memcmp(back.data, data, sizeof(data)) == 0);
+
+  uint8_t tooLong[kMaxDataLength + 1] = {};
+  msg.data = tooLong;
+  msg.dataLength = kMaxDataLength;
+  CHECK(encode(out, sizeof(out), msg) != 0);
+  CHECK_EQ(encode(out, kHeaderLength + kMaxDataLength + 1, msg), 0u);
+}
+
+static void testChecksumRejection() {
+  uint8_t out[kMaxMessageLength];
+  size_t len = get(out, sizeof(out), kController, Uid{1, 2}, 9, DeviceInfo);
+  Message msg;
+  CHECK(decode(out, len, msg));
+
+  for (size_t i = 1; i < len; ++i) {
+    uint8_t bad[kMaxMessageLength];
+    memcpy(bad, out, len);
+    bad[i] ^= 0x10;
+    Message ignored;
+    if (decode(bad, len, ignored)) std::printf("  accepted flipped byte %u\n", static_cast<unsigned>(i));
+    CHECK(!decode(bad, len, ignored));
+  }
+  CHECK(!decode(out, len - 1, msg));  // truncated checksum
+}
+
+static void testDiscoveryResponse() {
+  const Uid uid {0x7FF0, 0x12345678};
+  uint8_t out[kDiscoveryResponseLength];
+  CHECK_EQ(encodeDiscoveryResponse(out, sizeof(out), uid), kDiscoveryResponseLength);
+  static const uint8_t kExpected[kDiscoveryResponseLength] = {
+      0xFE, 0xFE, 0xFE, 0xFE, 0xFE, 0xFE, 0xFE, 0xAA,
+      0xFF, 0x7F, 0xFA, 0xF5, 0xBA, 0x57, 0xBE, 0x75, 0xFE, 0x57, 0xFA, 0x7D,
+      0xAA, 0x5D, 0xFF, 0x7D,  // checksum 0x087D
+  };
+  CHECK(memcmp(out, kExpected, sizeof(out)) == 0);
+
+  Uid back;
+  CHECK(decodeDiscoveryResponse(out, sizeof(out), back));
+  CHECK(back == uid);
+  CHECK(decodeDiscoveryResponse(out + 5, sizeof(out) - 5, back));  // short preamble
+  CHECK(back == uid);
+  CHECK(!decodeDiscoveryResponse(out, sizeof(out) - 1, back));
+
+  // Two responders answering at once: the line carries the AND of both.
+  uint8_t other[kDiscoveryResponseLength];
+  encodeDiscoveryResponse(other, sizeof(other), Uid{0x7FF0, 0x12345679});
+  for (size_t i = 0; i < sizeof(out); ++i) other[i] &= out[i];
+  CHECK(!decodeDiscoveryResponse(other, sizeof(other), back));
+}
+
+// Loopback fixtures. One shared line per port; the transport answers as the
+// responders on it would.
+struct Responder {
+  Uid uid;
+  uint16_t startAddress {1};
+  uint16_t footprint {8};
+  bool identifying {false};
+  bool muted {false};
+};
+
+static std::vector<Responder> gLine;
+static bool gNoGap = false;
+static unsigned gMalformed = 0;
+
+static uint64_t readUid(const uint8_t *p) {
+  uint64_t v = 0;
+  for (int i = 0; i < 6; ++i) v = v << 8 | p[i];
+  return v;
+}
+
+static int reply(const Responder &r, const Message &req, uint8_t response, const uint8_t *data,
+                 uint8_t dataLength, uint8_t *out, size_t capacity) {
+  Message msg;
+  msg.destination = req.source;
+  msg.source = r.uid;
+  msg.transaction = req.transaction;
+  msg.portOrResponse = response;
+  msg.commandClass = req.commandClass + 1;
+  msg.pid = req.pid;
+  msg.data = data;
+  msg.dataLength = dataLength;
+  if (capacity < 1) return 0;
+  out[0] = 0x00;  // the response break as a null byte
+  return static_cast<int>(encode(out + 1, capacity - 1, msg) + 1);
+}
+
+static int answer(Responder &r, const Message &req, uint8_t *out, size_t capacity) {
+  uint8_t data[19] = {};
+  if (req.commandClass == Discovery) {
+    r.muted = req.pid == DiscMute;
+    return reply(r, req, Ack, data, 2, out, capacity);  // control field
+  }
+  if (req.commandClass == Get && req.pid == DeviceInfo) {
+    const uint8_t info[19] = {0x01, 0x00, 0x12, 0x34, 0x01, 0x01, 0, 0, 0x02, 0x05,
+                              static_cast<uint8_t>(r.footprint >> 8),
+                              static_cast<uint8_t>(r.footprint), 1, 1,
+                              static_cast<uint8_t>(r.startAddress >> 8),
+                              static_cast<uint8_t>(r.startAddress), 0, 0, 0};
+    return reply(r, req, Ack, info, sizeof(info), out, capacity);
+  }
+  if (req.commandClass == Get && req.pid == DmxStartAddress) {
+    data[0] = r.startAddress >> 8;
+    data[1] = r.startAddress & 0xFF;
+    return reply(r, req, Ack, data, 2, out, capacity);
+  }
+  if (req.commandClass == Set && req.pid == DmxStartAddress && req.dataLength == 2) {
+    uint16_t address = req.data[0] << 8 | req.data[1];
+    if (address < 1 || address + r.footprint - 1 > 512) {
+      return reply(r, req, NackReason, data, 2, out, capacity);
+    }
+    r.startAddress = address;
+    return reply(r, req, Ack, nullptr, 0, out, capacity);
+  }
+  if (req.commandClass == Set && req.pid == IdentifyDevice && req.dataLength == 1) {
+    r.identifying = req.data[0] != 0;
+    return reply(r, req, Ack, nullptr, 0, out, capacity);
+  }
+  return reply(r, req, NackReason, data, 2, out, capacity);
+}
+
+static int loopback(uint8_t, const uint8_t *request, size_t length, uint8_t *response,
+                    size_t capacity, bool discovery) {
+  if (gNoGap) return -1;
+  Message req;
+  if (!decode(request, length, req)) {
+    gMalformed++;
+    return 0;
+  }
+
+  if (discovery) {
+    if (req.pid != DiscUniqueBranch || req.dataLength != 12) {
+      gMalformed++;
+      return 0;
+    }
+    uint64_t lower = readUid(req.data), upper = readUid(req.data + 6);
+    int n = 0;
+    uint8_t encoded[kDiscoveryResponseLength];
+    for (const Responder &r : gLine) {
+      if (r.muted || r.uid.value() < lower || r.uid.value() > upper) continue;
+      encodeDiscoveryResponse(encoded, sizeof(encoded), r.uid);
+      for (size_t i = 0; i < sizeof(encoded) && i < capacity; ++i) {
+        response[i] = n ? response[i] & encoded[i] : encoded[i];
+      }
+      n = static_cast<int>(std::min(sizeof(encoded), capacity));
+    }
+    return n;
+  }
+
+  bool broadcast = req.destination == kBroadcast;
+  int n = 0;
+  for (Responder &r : gLine) {
+    if (!broadcast && !(r.uid == req.destination)) continue;
+    int len = answer(r, req, response, capacity);
+    if (!broadcast) n = len;
+  }
+  return n;
+}
+
+static RDMClient::Session session() {
+  RDMClient::Session s;
+  s.uid = kController;
+  s.transport = loopback;
+  return s;
+}
+
+static bool contains(const std::vector<Uid> &uids, const Uid &uid) {
+  for (const Uid &u : uids) {
+    if (u == uid) return true;
+  }
+  return false;
+}
+
+static void testDiscovery() {
+  gLine = {
+      {Uid{0x7FF0, 0x00000001}}, {Uid{0x7FF0, 0x00000002}}, {Uid{0x7FF0, 0x80000000}},
+      {Uid{0x4C55, 0x1234ABCD}}, {Uid{0x0001, 0x00000000}},
+  };
+  gLine[1].muted = true;  // left over from an earlier run, cleared by the unmute broadcast
+  RDMClient::Session s = session();
+  std::vector<Uid> found;
+  CHECK(RDMClient::discover(s, 0, found, 64));
+  CHECK_EQ(found.size(), gLine.size());
+  for (const Responder &r : gLine) {
+    CHECK(contains(found, r.uid));
+    CHECK(r.muted);
+  }
+
+  found.clear();
+  CHECK(RDMClient::discover(s, 0, found, 2));
+  CHECK_EQ(found.size(), 2u);
+
+  gLine.clear();
+  found.clear();
+  CHECK(RDMClient::discover(s, 0, found, 64));
+  CHECK(found.empty());
+
+  gNoGap = true;
+  CHECK(!RDMClient::discover(s, 0, found, 64));
+  gNoGap = false;
+}
+
+static void testRequests() {
+  gLine = {{Uid{0x7FF0, 0x00000010}}, {Uid{0x7FF0, 0x00000020}}};
+  gLine[1].startAddress = 100;
+  gLine[1].footprint = 12;
+  RDMClient::Session s = session();
+  const Uid fixture = gLine[1].uid;
+
+  DeviceInfoData info;
+  CHECK(RDMClient::getDeviceInfo(s, 0, fixture, info));
+  CHECK_EQ(info.protocolVersion, 0x0100);
+  CHECK_EQ(info.model, 0x1234);
+  CHECK_EQ(info.footprint, 12);
+  CHECK_EQ(info.startAddress, 100);
+
+  uint16_t address = 0;
+  CHECK(RDMClient::getStartAddress(s, 0, fixture, address));
+  CHECK_EQ(address, 100);
+  CHECK(RDMClient::setStartAddress(s, 0, fixture, 201));
+  CHECK(RDMClient::getStartAddress(s, 0, fixture, address));
+  CHECK_EQ(address, 201);
+  CHECK_EQ(gLine[0].startAddress, 1);  // the other fixture is untouched
+
+  CHECK(!RDMClient::setStartAddress(s, 0, fixture, 510));  // footprint past 512: NACK
+  CHECK(!RDMClient::setStartAddress(s, 0, fixture, 0));    // rejected before sending
+  CHECK_EQ(gLine[1].startAddress, 201);
+
+  CHECK(RDMClient::identify(s, 0, fixture, true));
+  CHECK(gLine[1].identifying);
+  CHECK(!gLine[0].identifying);
+  CHECK(RDMClient::identify(s, 0, fixture, false));
+  CHECK(!gLine[1].identifying);
+
+  CHECK(!RDMClient::getDeviceInfo(s, 0, Uid{0x7FF0, 0x00000030}, info));  // nobody answers
+  CHECK_EQ(gMalformed, 0u);
+}
+
+int main() {
+  testRoundTrip();
+  testChecksumRejection();
+  testDiscoveryResponse();
+  testDiscovery();
+  testRequests();
+  return finish("rdm");
+}
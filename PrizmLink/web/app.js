@@ -120,6 +120,47 @@ const initGlitchPing = () => {
   }, 5000);
 };
 
+// Live pixel preview over /ws: subscribe, then apply key/delta frames
+// (format in pixel_preview.h) to the canvas. Text messages are status JSON.
+const initPixelPreview = () => {
+  const canvas = q('#pixel-preview');
+  if (!canvas || !location.protocol.startsWith('http')) return;
+  const ctx = canvas.getContext('2d');
+  const image = ctx.createImageData(canvas.width, 1);
+  const socket = new WebSocket(`ws://${location.host}/ws`);
+  socket.binaryType = 'arraybuffer';
+
+  socket.addEventListener('open', () => {
+    socket.send(JSON.stringify({ preview: { fps: 10, pixels: canvas.width } }));
+  });
+
+  socket.addEventListener('message', (event) => {
+    if (typeof event.data === 'string') return;
+    const bytes = new Uint8Array(event.data);
+    if (bytes[0] !== 0x50) return;
+    const count = Math.min(bytes[2] | (bytes[3] << 8), canvas.width);
+    let pos = 4;
+    let px = 0;
+    const put = (i, r, g, b) => {
+      if (i >= count) return;
+      image.data.set([r, g, b, 255], i * 4);
+    };
+    while (pos < bytes.length) {
+      const control = bytes[pos++];
+      const len = (control & 0x3f) + 1;
+      const kind = control & 0xc0;
+      if (kind === 0x00) {
+        for (let k = 0; k < len; k += 1, pos += 3) put(px + k, bytes[pos], bytes[pos + 1], bytes[pos + 2]);
+      } else if (kind === 0x40) {
+        for (let k = 0; k < len; k += 1) put(px + k, bytes[pos], bytes[pos + 1], bytes[pos + 2]);
+        pos += 3;
+      }
+      px += len;
+    }
+    ctx.putImageData(image, 0, 0);
+  });
+};
+
 const updateYear = () => {
   const yearEl = q('#year');
   if (yearEl) yearEl.textContent = new Date().getFullYear();
@@ -133,5 +174,6 @@ document.addEventListener('DOMContentLoaded', () => {
   bindAuthTabs();
   initReveal();
   initGlitchPing();
+  initPixelPreview();
   updateYear();
 });
@@ -3,9 +3,15 @@
 #include <WiFi.h>
 #include "config.h"
 #include "sd_logger.h"
+#include "network_e131.h"
+#include "pixel_output.h"
+#include "pixel_preview.h"
+#include "rdm_controller.h"
 #include <LittleFS.h>
 #include <ArduinoJson.h>
 #include <SD.h>
+#include <algorithm>
+#include <vector>
 
 namespace WebServer {
 
@@ -14,15 +20,204 @@ static AsyncWebSocket *sSocket = nullptr;
 static bool sReady = false;
 static Prizm::PrizmConfig sCfg;
 
+// Live pixel preview. A client opts in with a text message
+//   {"preview": {"fps": 10, "pixels": 300}}
+// and out with fps 0 or by disconnecting. Requests arrive on the async TCP
+// task and are queued here; loop() owns the subscription table, so with no
+// subscribers the preview costs one flag check.
+constexpr uint8_t kMaxPreviewClients = 4;
+constexpr uint16_t kMaxPreviewPixels = 1024;
+constexpr uint8_t kKeyFrameInterval = 50;  // delta frames between key frames
+
+struct PreviewRequest {
+  uint32_t clientId {0};
+  uint8_t fps {0};
+  uint16_t pixels {0};
+  bool pending {false};
+};
+
+struct PreviewClient {
+  uint32_t clientId {0};
+  bool active {false};
+  uint32_t intervalMs {0};
+  uint32_t lastMs {0};
+  uint16_t pixels {0};
+  uint8_t sinceKey {0};
+  std::vector<uint8_t> previous;  // last frame the client was sent
+};
+
+static portMUX_TYPE sPreviewMux = portMUX_INITIALIZER_UNLOCKED;
+static PreviewRequest sPreviewRequests[kMaxPreviewClients];
+static volatile bool sPreviewPending = false;
+static PreviewClient sPreviewClients[kMaxPreviewClients];
+static uint8_t sPreviewCount = 0;
+static std::vector<uint8_t> sPreviewRgb;
+static std::vector<uint8_t> sPreviewOut;
+
+// Universe range change from /config/universes, handed to loop() as a
+// single slot under its own lock, so it never waits on preview traffic.
+struct UniverseChange {
+  uint16_t startUniverse {0};
+  uint16_t universeCount {0};
+  uint16_t channelsPerUniverse {0};
+};
+static portMUX_TYPE sUniverseMux = portMUX_INITIALIZER_UNLOCKED;
+static UniverseChange sUniverseChange;
+static volatile bool sUniverseChangePending = false;
+
+static void queuePreview(uint32_t clientId, uint8_t fps, uint16_t pixels) {
+  bool queued = false;
+  portENTER_CRITICAL(&sPreviewMux);
+  PreviewRequest *slot = nullptr;
+  for (auto &req : sPreviewRequests) {
+    if (req.pending && req.clientId == clientId) {
+      slot = &req;
+      break;
+    }
+    if (!req.pending && !slot) slot = &req;
+  }
+  if (slot) {
+    slot->clientId = clientId;
+    slot->fps = fps;
+    slot->pixels = pixels;
+    slot->pending = true;
+    sPreviewPending = true;
+    queued = true;
+  }
+  portEXIT_CRITICAL(&sPreviewMux);
+  if (!queued) Debug::warn("WS", "Preview request from %u dropped", clientId);
+}
+
+static void applyPreviewRequest(const PreviewRequest &req) {
+  PreviewClient *client = nullptr;
+  PreviewClient *free = nullptr;
+  for (auto &c : sPreviewClients) {
+    if (c.active && c.clientId == req.clientId) client = &c;
+    if (!c.active && !free) free = &c;
+  }
+
+  uint8_t fps = std::min(req.fps, sCfg.web.previewFps);
+  if (fps == 0 || req.pixels == 0) {
+    if (client) {
+      *client = PreviewClient();
+      sPreviewCount--;
+    }
+    return;
+  }
+  if (!client) {
+    if (!free) {
+      Debug::warn("WS", "Preview full, client %u refused", req.clientId);
+      return;
+    }
+    client = free;
+    client->active = true;
+    client->clientId = req.clientId;
+    sPreviewCount++;
+  }
+  client->intervalMs = 1000 / fps;
+  client->pixels = std::min(req.pixels, kMaxPreviewPixels);
+  client->previous.clear();  // next frame is a key frame
+  client->sinceKey = 0;
+  Debug::info("WS", "Preview for %u: %u px at %u fps", req.clientId, client->pixels, fps);
+}
+
+static void servicePreview(uint32_t nowMs) {
+  if (sPreviewPending) {
+    PreviewRequest requests[kMaxPreviewClients];
+    portENTER_CRITICAL(&sPreviewMux);
+    for (uint8_t i = 0; i < kMaxPreviewClients; ++i) {
+      requests[i] = sPreviewRequests[i];
+      sPreviewRequests[i].pending = false;
+    }
+    sPreviewPending = false;
+    portEXIT_CRITICAL(&sPreviewMux);
+    for (const auto &req : requests) {
+      if (req.pending) applyPreviewRequest(req);
+    }
+  }
+  if (sPreviewCount == 0) return;
+
+  for (auto &c : sPreviewClients) {
+    if (!c.active || nowMs - c.lastMs < c.intervalMs) continue;
+    AsyncWebSocketClient *client = sSocket->client(c.clientId);
+    if (!client) {
+      c = PreviewClient();
+      sPreviewCount--;
+      continue;
+    }
+    if (client->queueIsFull()) continue;  // slow link: skip, the next delta still applies
+    c.lastMs = nowMs;
+
+    size_t bytes = static_cast<size_t>(c.pixels) * 3;
+    sPreviewRgb.resize(bytes);
+    sPreviewOut.resize(PixelPreview::maxEncodedSize(c.pixels));
+    PixelOutput::sample(sPreviewRgb.data(), c.pixels);
+
+    bool key = c.previous.size() != bytes || c.sinceKey >= kKeyFrameInterval;
+    size_t len = PixelPreview::encode(sPreviewOut.data(), sPreviewRgb.data(),
+                                      key ? nullptr : c.previous.data(), c.pixels);
+    if (len == 0) continue;  // unchanged
+    client->binary(sPreviewOut.data(), len);
+    c.previous = sPreviewRgb;
+    c.sinceKey = key ? 0 : c.sinceKey + 1;
+  }
+}
+
 static String processor(const String &var) {
   if (var == "VERSION") return Prizm::kFirmwareVersion;
   if (var == "IP") return WiFi.localIP().toString();
   return String();
 }
 
-static void handleWsMessage(void *arg, uint8_t *data, size_t len) {
+static void sendRdmDevices(AsyncWebServerRequest *request) {
+  std::vector<RDMController::Device> devices = RDMController::devices();
+  DynamicJsonDocument doc(256 + devices.size() * 192);
+  doc["controller"] = RDMController::uidToString(RDMController::controllerUid());
+  doc["busy"] = RDMController::busy();
+  JsonArray list = doc.createNestedArray("devices");
+  for (const auto &device : devices) {
+    JsonObject obj = list.createNestedObject();
+    obj["uid"] = RDMController::uidToString(device.uid);
+    obj["port"] = device.port;
+    if (!device.infoValid) continue;
+    obj["model"] = device.info.model;
+    obj["category"] = device.info.category;
+    obj["software"] = device.info.softwareVersion;
+    obj["footprint"] = device.info.footprint;
+    obj["personality"] = device.info.personality;
+    obj["address"] = device.info.startAddress;
+  }
+  String json;
+  serializeJson(doc, json);
+  request->send(200, "application/json", json);
+}
+
+// Reads the `uid` query parameter; replies 400 itself when it is missing.
+static bool rdmTarget(AsyncWebServerRequest *request, RDM::Uid &uid) {
+  if (!RDMController::isReady()) {
+    request->send(503, "text/plain", "RDM unavailable");
+    return false;
+  }
+  if (!request->hasParam("uid") ||
+      !RDMController::parseUid(request->getParam("uid")->value().c_str(), uid)) {
+    request->send(400, "text/plain", "uid required (mmmm:dddddddd)");
+    return false;
+  }
+  return true;
+}
+
+static void handleWsMessage(AsyncWebSocketClient *client, void *arg, uint8_t *data, size_t len) {
   AwsFrameInfo *info = static_cast<AwsFrameInfo *>(arg);
   if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT) {
+    StaticJsonDocument<128> doc;
+    if (!deserializeJson(doc, data, len) && doc.containsKey("preview")) {
+      JsonObject preview = doc["preview"];
+      int fps = preview["fps"] | 0;
+      int pixels = preview["pixels"] | 0;
+      queuePreview(client->id(), std::max(0, std::min(fps, 255)),
+                   std::max(0, std::min(pixels, 65535)));
+      return;
+    }
     String msg = String(reinterpret_cast<char*>(data), len);
     Debug::info("WS", "Received: %s", msg.c_str());
   }
@@ -51,9 +246,10 @@ bool begin(const Prizm::PrizmConfig &cfg) {
           break;
         case WS_EVT_DISCONNECT:
           Debug::info("WS", "Client disconnected (%u)", client->id());
+          queuePreview(client->id(), 0, 0);
           break;
         case WS_EVT_DATA:
-          handleWsMessage(arg, data, len);
+          handleWsMessage(client, arg, data, len);
           break;
         default:
           break;
@@ -66,6 +262,65 @@ bool begin(const Prizm::PrizmConfig &cfg) {
       request->send(200, "application/json", json);
     });
 
+    sServer->on("/config/universes", HTTP_POST, [](AsyncWebServerRequest *request) {
+      if (!request->hasParam("start") || !request->hasParam("count")) {
+        request->send(400, "text/plain", "start and count required");
+        return;
+      }
+      long start = request->getParam("start")->value().toInt();
+      long count = request->getParam("count")->value().toInt();
+      long channels = 512;
+      if (request->hasParam("channels")) channels = request->getParam("channels")->value().toInt();
+      if (start < 1 || start > 63999 || count < 1 || count > Prizm::kMaxUniverses ||
+          channels < 1 || channels > 512) {
+        request->send(400, "text/plain", "start 1-63999, count 1-12, channels 1-512");
+        return;
+      }
+      portENTER_CRITICAL(&sUniverseMux);
+      sUniverseChange.startUniverse = static_cast<uint16_t>(start);
+      sUniverseChange.universeCount = static_cast<uint16_t>(count);
+      sUniverseChange.channelsPerUniverse = static_cast<uint16_t>(channels);
+      sUniverseChangePending = true;
+      portEXIT_CRITICAL(&sUniverseMux);
+      request->send(202, "text/plain", "Queued");
+    });
+
+    sServer->on("/rdm", HTTP_GET, sendRdmDevices);
+
+    sServer->on("/rdm/discover", HTTP_POST, [](AsyncWebServerRequest *request) {
+      if (!RDMController::isReady()) {
+        request->send(503, "text/plain", "RDM unavailable");
+        return;
+      }
+      RDMController::discover();
+      request->send(202, "text/plain", "Discovery started");
+    });
+
+    sServer->on("/rdm/identify", HTTP_POST, [](AsyncWebServerRequest *request) {
+      RDM::Uid uid;
+      if (!rdmTarget(request, uid)) return;
+      bool on = !request->hasParam("on") || request->getParam("on")->value().toInt() != 0;
+      if (RDMController::identify(uid, on)) {
+        request->send(202, "text/plain", "Queued");
+      } else {
+        request->send(503, "text/plain", "RDM busy");
+      }
+    });
+
+    sServer->on("/rdm/address", HTTP_POST, [](AsyncWebServerRequest *request) {
+      RDM::Uid uid;
+      if (!rdmTarget(request, uid)) return;
+      long address = 0;
+      if (request->hasParam("address")) address = request->getParam("address")->value().toInt();
+      if (address < 1 || address > 512) {
+        request->send(400, "text/plain", "address must be 1-512");
+      } else if (RDMController::setStartAddress(uid, static_cast<uint16_t>(address))) {
+        request->send(202, "text/plain", "Queued");
+      } else {
+        request->send(503, "text/plain", "RDM busy");
+      }
+    });
+
     sServer->on("/logs/run_latest.txt", HTTP_GET, [](AsyncWebServerRequest *request) {
       if (!SDLogger::isReady()) {
         request->send(503, "text/plain", "SD logger unavailable");
@@ -106,6 +361,27 @@ void broadcastStatus(const Prizm::RuntimeStats &stats) {
   DynamicJsonDocument doc(1024);
   doc["fps"] = stats.fps;
   doc["packets"] = stats.packetCounter;
+  doc["stale"] = stats.packetsStale;
+  doc["duplicate"] = stats.packetsDuplicate;
+  doc["lost"] = stats.packetsLost;
+  doc["overruns"] = stats.frameOverruns;
+  doc["rxQueuePeak"] = stats.rxQueuePeak;
+  doc["artnet"] = stats.artnetPackets;
+  doc["ddp"] = stats.ddpPackets;
+  doc["pixelBusy"] = stats.pixelFramesBusy;
+  doc["pixelDropped"] = stats.pixelFramesDropped;
+  doc["pixelMa"] = stats.pixelMilliamps;
+  doc["pixelLimited"] = stats.pixelPowerLimited;
+  doc["dmxFrames"] = stats.dmxFrames;
+  doc["dmxMissed"] = stats.dmxMissed;
+  doc["dmxInFps"] = stats.dmxInFps;
+  doc["dmxInSlots"] = stats.dmxInSlots;
+  JsonObject universes = doc.createNestedObject("universes");
+  for (uint16_t i = 0; i < sCfg.e131.universeCount; ++i) {
+    uint16_t universe = sCfg.e131.startUniverse + i;
+    universes[String(universe)] = NetworkE131::universePackets(universe);
+  }
+  doc["groups"] = NetworkE131::multicastGroupCount();
   doc["manual"] = stats.manualOverride;
   doc["uptime"] = millis();
   String json;
@@ -113,12 +389,27 @@ void broadcastStatus(const Prizm::RuntimeStats &stats) {
   sSocket->textAll(json);
 }
 
+bool takeUniverseChange(Prizm::E131Config &cfg) {
+  if (!sUniverseChangePending) return false;
+  portENTER_CRITICAL(&sUniverseMux);
+  UniverseChange change = sUniverseChange;
+  sUniverseChangePending = false;
+  portEXIT_CRITICAL(&sUniverseMux);
+
+  cfg.startUniverse = change.startUniverse;
+  cfg.universeCount = change.universeCount;
+  cfg.channelsPerUniverse = change.channelsPerUniverse;
+  sCfg.e131 = cfg;
+  return true;
+}
+
 void loop(const Prizm::RuntimeStats &stats) {
   if (!sReady) return;
   if (millis() - Prizm::Config::stats.lastWebsocketMs > 1000) {
     broadcastStatus(stats);
     Prizm::Config::stats.lastWebsocketMs = millis();
   }
+  servicePreview(millis());
 }
 
 } // namespace WebServer
@@ -11,5 +11,9 @@ bool begin(const Prizm::PrizmConfig &cfg);
 void loop(const Prizm::RuntimeStats &stats);
 void broadcastStatus(const Prizm::RuntimeStats &stats);
 
+// Universe range posted to /config/universes, merged into `cfg`. Call from
+// loop(); returns false when nothing is pending.
+bool takeUniverseChange(Prizm::E131Config &cfg);
+
 } // namespace WebServer
 